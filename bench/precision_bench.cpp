@@ -0,0 +1,145 @@
+// Accuracy/throughput of f64, f32 and mixed precision propagation.
+// LEO ensemble with J2, RK4 at a fixed step, errors against the f64 run.
+//
+//   f64   : state, force sum and all policies in f64
+//   f32   : state and all policies in f32 (vec6f)
+//   mixed : f64 state and central term, J2 evaluated in f32 (Float32Policy)
+//
+// Both f32 modes use absolute positions; there is no per-object reference.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "FixedIntegrators.h"
+#include "constants.h"
+#include "gravity.h"
+#include "typedefs.h"
+
+const std::vector<f64> J_EARTH = {0., 1.08262668e-3};
+
+// Propagate every object over [0, tf] and return the final states
+template <typename State, typename F>
+std::vector<State>
+propagate(const F &f, const std::vector<State> &x0, f64 tf, f64 dt) {
+    std::vector<State> xf;
+    xf.reserve(x0.size());
+    for (const State &x : x0) {
+        f64 t = 0.;
+        State y = x;
+        while (t < tf) {
+            std::tie(t, y) = RK4Policy<F, State>::step(f, t, y, dt);
+        }
+        xf.push_back(y);
+    }
+    return xf;
+}
+
+template <typename Fn> f64 time_ms(Fn &&fn) {
+    auto t0 = std::chrono::steady_clock::now();
+    fn();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<f64, std::milli>(t1 - t0).count();
+}
+
+template <typename State>
+void report(
+    const char *name,
+    f64 ms,
+    const std::vector<State> &xf,
+    const std::vector<vec6> &ref,
+    size_t steps
+) {
+    f64 err_max = 0.;
+    f64 err_rms = 0.;
+    for (size_t i = 0; i < ref.size(); i++) {
+        f64 e = (xf[i].template cast<f64>() - ref[i]).template head<3>().norm();
+        err_max = std::max(err_max, e);
+        err_rms += e * e;
+    }
+    err_rms = std::sqrt(err_rms / ref.size());
+    std::printf(
+        "%-6s %9.1f ms %9.2f Msteps/s   rms %.3e km   max %.3e km\n",
+        name,
+        ms,
+        steps / (ms * 1e3),
+        err_rms,
+        err_max
+    );
+}
+
+int main() {
+    const size_t n_obj = 256;
+    const f64 tf = 86400.;
+    const f64 dt = 10.;
+    const size_t steps = n_obj * static_cast<size_t>(tf / dt);
+
+    // Circular-ish LEO shell, spread in altitude, inclination and node
+    std::vector<vec6> x0(n_obj);
+    for (size_t i = 0; i < n_obj; i++) {
+        f64 r = r_earth + 400. + 1200. * i / n_obj;
+        f64 inc = deg2rad * (20. + 80. * ((i * 7) % n_obj) / n_obj);
+        f64 raan = twopi * ((i * 13) % n_obj) / n_obj;
+        f64 v = std::sqrt(mu_earth / r) * 1.001;
+        vec3 p(r * std::cos(raan), r * std::sin(raan), 0.);
+        vec3 w(
+            -v * std::sin(raan) * std::cos(inc),
+            v * std::cos(raan) * std::cos(inc),
+            v * std::sin(inc)
+        );
+        x0[i] << p, w;
+    }
+    std::vector<vec6f> x0f;
+    for (const vec6 &x : x0) {
+        x0f.push_back(x.cast<f32>());
+    }
+
+    // f64
+    using Force64 = ForcePolicy3D<
+        vec6,
+        NewtonianGravityPolicy<vec6>,
+        ZonalGravityPolicy<vec6>>;
+    EOM<vec6, Force64> eom64(Force64(
+        NewtonianGravityPolicy<vec6>(mu_earth),
+        ZonalGravityPolicy<vec6>(mu_earth, J_EARTH, r_earth, 2, false)
+    ));
+
+    // f32
+    using Force32 = ForcePolicy3D<
+        vec6f,
+        NewtonianGravityPolicy<vec6f>,
+        ZonalGravityPolicy<vec6f>>;
+    EOM<vec6f, Force32> eom32(Force32(
+        NewtonianGravityPolicy<vec6f>(mu_earth),
+        ZonalGravityPolicy<vec6f>(mu_earth, J_EARTH, r_earth, 2, false)
+    ));
+
+    // mixed
+    using J2f = Float32Policy<vec6, ZonalGravityPolicy<vec6f>>;
+    using ForceMixed
+        = ForcePolicy3D<vec6, NewtonianGravityPolicy<vec6>, J2f>;
+    EOM<vec6, ForceMixed> eom_mixed(ForceMixed(
+        NewtonianGravityPolicy<vec6>(mu_earth),
+        J2f(ZonalGravityPolicy<vec6f>(mu_earth, J_EARTH, r_earth, 2, false))
+    ));
+
+    std::printf(
+        "%zu objects, %.0f s at dt = %.0f s (RK4, two-body + J2)\n",
+        n_obj,
+        tf,
+        dt
+    );
+
+    std::vector<vec6> ref, xf_mixed;
+    std::vector<vec6f> xf32;
+    f64 ms64 = time_ms([&] { ref = propagate(eom64, x0, tf, dt); });
+    f64 ms32 = time_ms([&] { xf32 = propagate(eom32, x0f, tf, dt); });
+    f64 ms_mixed
+        = time_ms([&] { xf_mixed = propagate(eom_mixed, x0, tf, dt); });
+
+    report("f64", ms64, ref, ref, steps);
+    report("f32", ms32, xf32, ref, steps);
+    report("mixed", ms_mixed, xf_mixed, ref, steps);
+    return 0;
+}
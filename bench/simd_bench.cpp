@@ -0,0 +1,139 @@
+// Throughput of each SIMD kernel variant built into this binary, a check
+// that all variants return identical bits, and the batch registry step
+// against the per-entity policy step.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "batch.h"
+#include "constants.h"
+#include "gravity.h"
+#include "registry.h"
+#include "simd.h"
+
+template <typename Fn> f64 time_ns(Fn &&fn, int reps) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < reps; k++) {
+        fn();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<f64, std::nano>(t1 - t0).count() / reps;
+}
+
+int main() {
+    const size_t n = 4096;
+    const int reps = 2000;
+    const f64 J2 = 1.08262668e-3;
+
+    std::vector<f64> r(3 * n), q(4 * n), w(3 * n);
+    for (size_t i = 0; i < n; i++) {
+        f64 s = 7000. + 10. * i;
+        r[i] = s * std::cos(0.1 * i);
+        r[n + i] = s * std::sin(0.1 * i);
+        r[2 * n + i] = 0.3 * s * std::sin(0.07 * i);
+        vec4 ep = vec4(std::sin(i), std::cos(2. * i), 0.3, 1.).normalized();
+        for (int c = 0; c < 4; c++) {
+            q[c * n + i] = ep(c);
+        }
+        for (int c = 0; c < 3; c++) {
+            w[c * n + i] = 0.01 * (c + 1) * std::cos(0.3 * i);
+        }
+    }
+
+    const SimdKernels *variants[] = {
+        simd_kernels_baseline(),
+        simd_kernels_avx2(),
+        simd_kernels_avx512(),
+    };
+    std::printf("selected: %s\n\n", simd_kernels().name);
+    std::printf(
+        "ns per element     gravity_j2   axpy   ep_to_dcm   ep_kde\n"
+    );
+
+    std::vector<f64> a_ref, R_ref;
+    bool identical = true;
+    for (const SimdKernels *K : variants) {
+        if (!K || static_cast<int>(K->isa) > static_cast<int>(simd_detect())
+        ) {
+            continue;
+        }
+        std::vector<f64> a(3 * n), R(9 * n), dq(4 * n), y(3 * n);
+        auto g = [&] {
+            K->gravity_j2(n, r.data(), a.data(), mu_earth, J2, r_earth);
+        };
+        auto x = [&] { K->axpy(3 * n, 0.5, a.data(), r.data(), y.data()); };
+        auto d = [&] { K->ep_to_dcm(n, q.data(), R.data()); };
+        auto k = [&] { K->ep_kde(n, q.data(), w.data(), dq.data()); };
+        f64 t_g = time_ns(g, reps);
+        f64 t_a = time_ns(x, reps);
+        f64 t_d = time_ns(d, reps);
+        f64 t_k = time_ns(k, reps);
+        std::printf(
+            "%-16s %10.3f %8.3f %10.3f %8.3f\n",
+            K->name,
+            t_g / n,
+            t_a / (3 * n),
+            t_d / n,
+            t_k / n
+        );
+
+        if (a_ref.empty()) {
+            a_ref = a;
+            R_ref = R;
+        } else {
+            size_t na = a.size() * sizeof(f64);
+            size_t nR = R.size() * sizeof(f64);
+            identical = identical
+                        && std::memcmp(a.data(), a_ref.data(), na) == 0
+                        && std::memcmp(R.data(), R_ref.data(), nR) == 0;
+        }
+    }
+    std::printf("\nvariants bit-identical: %s\n", identical ? "yes" : "NO");
+
+    // Batch registry step vs the per-entity policy step
+    Registry reg_batch, reg_policy;
+    for (size_t i = 0; i < 1024; i++) {
+        for (Registry *reg : {&reg_batch, &reg_policy}) {
+            Entity e = reg->create("sat");
+            vec3 p(r[i], r[n + i], r[2 * n + i]);
+            vec3 v = vec3(-p(1), p(0), 0.).normalized()
+                     * std::sqrt(mu_earth / p.norm());
+            reg->pos[e] = p;
+            reg->vel[e] = v;
+        }
+    }
+    BatchTranslation batch(mu_earth, J2, r_earth);
+    ForcePolicy3D<vec6, NewtonianGravityPolicy<vec6>, ZonalGravityPolicy<vec6>>
+        forces{
+            NewtonianGravityPolicy<vec6>(mu_earth),
+            ZonalGravityPolicy<vec6>(mu_earth, {0., J2}, r_earth, 2, false)
+        };
+
+    const int steps = 200;
+    const f64 dt = 10.;
+    f64 t_batch = time_ns([&] { batch.step(reg_batch, dt); }, steps);
+    f64 t = 0.;
+    f64 t_policy = time_ns(
+        [&] {
+            translation_step(reg_policy, forces, t, dt);
+            t += dt;
+        },
+        steps
+    );
+    f64 diff = 0.;
+    for (size_t i = 0; i < reg_batch.size(); i++) {
+        diff = std::max(diff, (reg_batch.pos[i] - reg_policy.pos[i]).norm());
+    }
+    std::printf(
+        "\nRK4 step, 1024 entities: batch %.1f us, policy %.1f us, "
+        "max difference after %d steps %.2e km\n",
+        t_batch * 1e-3,
+        t_policy * 1e-3,
+        steps,
+        diff
+    );
+}
@@ -0,0 +1,109 @@
+# Writes ${OUT} with the degree <= MAX_DEGREE coefficients of every gravity
+# model file found in ${ASSETS_DIR} as constexpr EmbeddedGravityModel tables
+# (include/CelestialBody.h). Column layouts match EGMCoefficients::load_egm.
+#
+#   embed_gravity_models(ASSETS_DIR OUT MAX_DEGREE)
+
+function(embed_gravity_models ASSETS_DIR OUT MAX_DEGREE)
+    # name|year|file|n start|n length|m start|m length|C start|C length|
+    # S start|S length
+    set(MODELS
+        "EGM84|1984|EGM84.txt|0|5|5|5|10|15|25|15"
+        "EGM96|1996|EGM96.txt|0|4|4|4|8|20|28|20"
+        "EGM2008|2008|EGM2008.txt|0|5|5|5|13|22|38|22"
+    )
+    math(EXPR SIZE "(${MAX_DEGREE} + 1) * (${MAX_DEGREE} + 2) / 2")
+    math(EXPR LAST "${SIZE} - 1")
+
+    set(BODY "")
+    set(POINTERS "")
+    set(COUNT 0)
+    foreach(ENTRY IN LISTS MODELS)
+        string(REPLACE "|" ";" MODEL "${ENTRY}")
+        list(GET MODEL 0 NAME)
+        list(GET MODEL 1 YEAR)
+        list(GET MODEL 2 FILE)
+        set(PATH "${ASSETS_DIR}/${FILE}")
+        if (NOT EXISTS "${PATH}")
+            continue()
+        endif()
+        set_property(
+            DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS "${PATH}"
+        )
+        list(SUBLIST MODEL 3 8 COLS)
+        list(GET COLS 0 N_S)
+        list(GET COLS 1 N_L)
+        list(GET COLS 2 M_S)
+        list(GET COLS 3 M_L)
+        list(GET COLS 4 C_S)
+        list(GET COLS 5 C_L)
+        list(GET COLS 6 S_S)
+        list(GET COLS 7 S_L)
+
+        foreach(I RANGE ${LAST})
+            set(C_${I} "0.")
+            set(S_${I} "0.")
+        endforeach()
+
+        # Degrees ascend; stop at the first line past MAX_DEGREE
+        math(EXPR LIMIT "${SIZE} + 8")
+        file(STRINGS "${PATH}" LINES LIMIT_COUNT ${LIMIT})
+        foreach(LINE IN LISTS LINES)
+            string(SUBSTRING "${LINE}" ${N_S} ${N_L} N)
+            string(STRIP "${N}" N)
+            if (N GREATER MAX_DEGREE)
+                break()
+            endif()
+            string(SUBSTRING "${LINE}" ${M_S} ${M_L} M)
+            string(SUBSTRING "${LINE}" ${C_S} ${C_L} C)
+            string(SUBSTRING "${LINE}" ${S_S} ${S_L} S)
+            string(STRIP "${M}" M)
+            string(REPLACE " " "" C "${C}")
+            string(REPLACE " " "" S "${S}")
+            string(REPLACE "D" "E" C "${C}")
+            string(REPLACE "D" "E" S "${S}")
+            math(EXPR I "${N} * (${N} + 1) / 2 + ${M}")
+            set(C_${I} "${C}")
+            set(S_${I} "${S}")
+        endforeach()
+
+        set(C_LIST "")
+        set(S_LIST "")
+        foreach(I RANGE ${LAST})
+            string(APPEND C_LIST "        ${C_${I}},\n")
+            string(APPEND S_LIST "        ${S_${I}},\n")
+        endforeach()
+
+        string(TOLOWER "${NAME}" LOWER)
+        string(APPEND BODY
+            "#define OADCS_EMBEDDED_${NAME} 1\n"
+            "inline constexpr EmbeddedGravityModel ${LOWER}_embedded{\n"
+            "    \"${NAME}\",\n    ${YEAR},\n"
+            "    {\n${C_LIST}    },\n"
+            "    {\n${S_LIST}    },\n};\n\n"
+        )
+        string(APPEND POINTERS "    &${LOWER}_embedded,\n")
+        math(EXPR COUNT "${COUNT} + 1")
+    endforeach()
+
+    set(TEXT
+        "// Generated by cmake/EmbedGravityModels.cmake from the gravity\n"
+    )
+    string(APPEND TEXT
+        "// model files in assets/. Do not edit.\n\n"
+        "#pragma once\n\n#include <array>\n\n"
+        "#include \"CelestialBody.h\"\n\n"
+        "static_assert(EmbeddedGravityModel::max_degree == ${MAX_DEGREE});\n\n"
+        "${BODY}"
+        "inline constexpr std::array<const EmbeddedGravityModel *, ${COUNT}>\n"
+        "    embedded_gravity_models{\n${POINTERS}};\n"
+    )
+
+    # Rewrite only on change so dependents are not rebuilt every configure
+    if (EXISTS "${OUT}")
+        file(READ "${OUT}" OLD)
+    endif()
+    if (NOT "${OLD}" STREQUAL "${TEXT}")
+        file(WRITE "${OUT}" "${TEXT}")
+    endif()
+endfunction()
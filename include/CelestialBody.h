@@ -1,11 +1,28 @@
 #pragma once 
 
+#include <algorithm>
+#include <array>
 #include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 #include "typedefs.h"
-#include "Body.h"
 
-struct CelestialBody : public Body {};
+// Low degree truncation of a gravity model, generated at build time from
+// assets/ (egm_embedded.h). Same normalization as the model file, stored
+// triangular: (n, m) at n (n + 1) / 2 + m.
+struct EmbeddedGravityModel {
+    static constexpr int max_degree = 20;
+    static constexpr int size = (max_degree + 1) * (max_degree + 2) / 2;
+
+    const char *name;
+    int year;
+    std::array<f64, size> C;
+    std::array<f64, size> S;
+
+    static constexpr int tri(int n, int m) { return n * (n + 1) / 2 + m; }
+};
 
 struct EGMCoefficients {
     int max_degree, max_order; // max_degree = N, max_order = M
@@ -17,6 +34,26 @@ struct EGMCoefficients {
         : max_degree(N), max_order(M), C((N + 1) * (M + 1), 0.),
           S((N + 1) * (M + 1), 0.) {};
 
+    // From an embedded table, no file access; same values as load_egm on the
+    // model file
+    EGMCoefficients(const EmbeddedGravityModel &model, int N, int M)
+        : EGMCoefficients(N, M) {
+        if (N > EmbeddedGravityModel::max_degree) {
+            throw std::runtime_error(
+                std::string(model.name) + " is embedded to degree "
+                + std::to_string(EmbeddedGravityModel::max_degree)
+                + ", load_egm the model file for degree "
+                + std::to_string(N)
+            );
+        }
+        for (int n = 0; n <= N; n++) {
+            for (int m = 0; m <= std::min(n, M); m++) {
+                C[idx(n, m)] = model.C[EmbeddedGravityModel::tri(n, m)];
+                S[idx(n, m)] = model.S[EmbeddedGravityModel::tri(n, m)];
+            }
+        }
+    }
+
     void load_egm(std::string filename, int year) {
         int n_ind_s, m_ind_s, C_ind_s, S_ind_s;
         int n_ind_e, m_ind_e, C_ind_e, S_ind_e;
@@ -64,6 +101,9 @@ struct EGMCoefficients {
             break;
         }
         default:
+            throw std::runtime_error(
+                "Unknown Gravity Model year: " + std::to_string(year)
+            );
         }
 
         int n = 0, m = 0;
@@ -94,7 +134,7 @@ struct EGMCoefficients {
             Cnm = std::stod(temp);
             temp = line.substr(S_ind_s, S_ind_e - S_ind_s + 1);
             std::erase(temp, ' ');
-            Snm = std::stoi(temp);
+            Snm = std::stod(temp);
 
             if (n >= 0 && n <= max_degree && m >= 0 && m <= max_order) {
                 C[idx(n, m)] = Cnm;
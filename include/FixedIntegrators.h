@@ -6,13 +6,17 @@
 // -----------------------------------------------------------------------------
 // Fixed Step Integrators
 // -----------------------------------------------------------------------------
+// Arithmetic is carried out in the state's scalar type S (f64 or f32); time
+// stays f64.
 
 // RK1/Euler
 template <typename F, typename State> struct RK1Policy {
     static std::pair<f64, State>
     step(const F &f, double t, const State &x, double dt) {
+        using S = scalar_t<State>;
+        const S h = S(dt);
         State k1 = f(t, x);
-        State x_new = x + dt * k1;
+        State x_new = x + h * k1;
         f64 t_new = t + dt;
         return {t_new, x_new};
     }
@@ -22,9 +26,11 @@ template <typename F, typename State> struct RK1Policy {
 template <typename F, typename State> struct RK2Policy {
     static std::pair<f64, State>
     step(const F &f, double t, const State &x, double dt) {
+        using S = scalar_t<State>;
+        const S h = S(dt);
         State k1 = f(t, x);
-        State k2 = f(t + dt / 2., x + dt * k1 / 2.);
-        State x_new = x + dt * k2;
+        State k2 = f(t + dt / 2., x + h * k1 / S(2));
+        State x_new = x + h * k2;
         f64 t_new = t + dt;
         return {t_new, x_new};
     }
@@ -34,10 +40,12 @@ template <typename F, typename State> struct RK2Policy {
 template <typename F, typename State> struct RK3Policy {
     static std::pair<f64, State>
     step(const F &f, double t, const State &x, double dt) {
+        using S = scalar_t<State>;
+        const S h = S(dt);
         State k1 = f(t, x);
-        State k2 = f(t + dt / 2., x + dt * k1 / 2.);
-        State k3 = f(t + dt, x - dt * k1 + 2. * dt * k2);
-        State x_new = x + dt * (k1 + 4. * k2 + k3) / 6.;
+        State k2 = f(t + dt / 2., x + h * k1 / S(2));
+        State k3 = f(t + dt, x - h * k1 + S(2) * h * k2);
+        State x_new = x + h * (k1 + S(4) * k2 + k3) / S(6);
         f64 t_new = t + dt;
         return {t_new, x_new};
     }
@@ -47,11 +55,13 @@ template <typename F, typename State> struct RK3Policy {
 template <typename F, typename State> struct RK4Policy {
     static std::pair<f64, State>
     step(const F &f, double t, const State &x, double dt) {
+        using S = scalar_t<State>;
+        const S h = S(dt);
         State k1 = f(t, x);
-        State k2 = f(t + dt / 2., x + dt * k1 / 2);
-        State k3 = f(t + dt / 2., x + dt * k2 / 2);
-        State k4 = f(t + dt, x + dt * k3);
-        State x_new = x + dt / 6. * (k1 + 2 * k2 + 2 * k3 + k4);
+        State k2 = f(t + dt / 2., x + h * k1 / S(2));
+        State k3 = f(t + dt / 2., x + h * k2 / S(2));
+        State k4 = f(t + dt, x + h * k3);
+        State x_new = x + h / S(6) * (k1 + S(2) * k2 + S(2) * k3 + k4);
         f64 t_new = t + dt;
         return {t_new, x_new};
     }
@@ -61,22 +71,27 @@ template <typename F, typename State> struct RK4Policy {
 template <typename F, typename State> struct RK5Policy {
     static std::pair<f64, State>
     step(const F &f, double t, const State &x, double dt) {
+        using S = scalar_t<State>;
+        const S h = S(dt);
         State k1 = f(t, x);
-        State k2 = f(t + dt / 4., x + dt * k1 / 4.);
-        State k3 = f(t + dt / 4., x + dt * (k1 / 8. + k2 / 8.));
-        State k4 = f(t + dt / 2., x + dt * (-k2 / 2. + k3));
+        State k2 = f(t + dt / 4., x + h * k1 / S(4));
+        State k3 = f(t + dt / 4., x + h * (k1 / S(8) + k2 / S(8)));
+        State k4 = f(t + dt / 2., x + h * (-k2 / S(2) + k3));
         State k5
-            = f(t + 3. * dt / 4., x + dt * (3. * k1 / 16. + 9. * k4 / 16.));
+            = f(t + 3. * dt / 4.,
+                x + h * (S(3. / 16.) * k1 + S(9. / 16.) * k4));
         State k6
             = f(t + dt,
                 x
-                    + dt
-                          * (-3. * k1 / 7. + 2. * k2 / 7. + 12. * k3 / 7.
-                             - 12. * k4 / 7. + 8. * k5 / 7.));
+                    + h
+                          * (S(-3. / 7.) * k1 + S(2. / 7.) * k2
+                             + S(12. / 7.) * k3 - S(12. / 7.) * k4
+                             + S(8. / 7.) * k5));
         State x_new = x
-                      + dt
-                            * (7. * k1 / 90. + 32. * k3 / 90. + 12. * k4 / 90.
-                               + 32. * k5 / 90. + 7. * k6 / 90.);
+                      + h
+                            * (S(7. / 90.) * k1 + S(32. / 90.) * k3
+                               + S(12. / 90.) * k4 + S(32. / 90.) * k5
+                               + S(7. / 90.) * k6);
         f64 t_new = t + dt;
         return {t_new, x_new};
     }
@@ -86,36 +101,42 @@ template <typename F, typename State> struct RK5Policy {
 template <typename F, typename State> struct RK6Policy {
     static std::pair<f64, State>
     step(const F &f, double t, const State &x, double dt) {
+        using S = scalar_t<State>;
+        const S h = S(dt);
         State k1 = f(t, x);
-        State k2 = f(t + dt / 5., x + dt * k1 / 5.);
-        State k3 = f(t + dt / 5., x + dt * (3. * k1 / 40. + 9. * k2 / 40.));
+        State k2 = f(t + dt / 5., x + h * k1 / S(5));
+        State k3
+            = f(t + dt / 5., x + h * (S(3. / 40.) * k1 + S(9. / 40.) * k2));
         State k4
             = f(t + dt / 2.,
-                x + dt * (3. * k1 / 10. - 9. * k2 / 10. + 6. * k3 / 10.));
+                x
+                    + h
+                          * (S(3. / 10.) * k1 - S(9. / 10.) * k2
+                             + S(6. / 10.) * k3));
         State k5
             = f(t + 3. * dt / 4.,
                 x
-                    + dt
-                          * (-11. * k1 / 54. + 5. * k2 / 2. - 70. * k3 / 27.
-                             + 35. * k4 / 27.));
+                    + h
+                          * (S(-11. / 54.) * k1 + S(5. / 2.) * k2
+                             - S(70. / 27.) * k3 + S(35. / 27.) * k4));
         State k6
             = f(t + dt,
                 x
-                    + dt
-                          * (1631. * k1 / 55296. + 175. * k2 / 512.
-                             + 575. * k3 / 13824. + 44275. * k4 / 110592.
-                             + 253. * k5 / 4096.));
+                    + h
+                          * (S(1631. / 55296.) * k1 + S(175. / 512.) * k2
+                             + S(575. / 13824.) * k3
+                             + S(44275. / 110592.) * k4
+                             + S(253. / 4096.) * k5));
         State k7
             = f(t + dt,
                 x
-                    + dt
-                          * (37. * k1 / 378. + 0. * k2 + 250. * k3 / 621.
-                             + 125. * k4 / 594. + 0. * k5 + 512. * k6 / 1771.));
-        State x_new
-            = x
-              + dt
-                    * (37. * k1 / 378. + 0. * k2 + 250. * k3 / 621.
-                       + 125. * k4 / 594. + 0. * k5 + 512. * k6 / 1771.);
+                    + h
+                          * (S(37. / 378.) * k1 + S(250. / 621.) * k3
+                             + S(125. / 594.) * k4 + S(512. / 1771.) * k6));
+        State x_new = x
+                      + h
+                            * (S(37. / 378.) * k1 + S(250. / 621.) * k3
+                               + S(125. / 594.) * k4 + S(512. / 1771.) * k6);
         f64 t_new = t + dt;
         return {t_new, x_new};
     }
@@ -125,9 +146,11 @@ template <typename F, typename State> struct RK6Policy {
 template <typename F, typename State> struct HeunPolicy {
     static std::pair<f64, State>
     step(const F &f, double t, const State &x, double dt) {
+        using S = scalar_t<State>;
+        const S h = S(dt);
         State k1 = f(t, x);
-        State k2 = f(t + dt, x + dt * k1);
-        State x_new = x + dt * (k1 + k2) / 2.;
+        State k2 = f(t + dt, x + h * k1);
+        State x_new = x + h * (k1 + k2) / S(2);
         f64 t_new = t + dt;
         return {t_new, x_new};
     }
@@ -137,10 +160,12 @@ template <typename F, typename State> struct HeunPolicy {
 template <typename F, typename State> struct RalstonPolicy {
     static std::pair<f64, State>
     step(const F &f, double t, const State &x, double dt) {
+        using S = scalar_t<State>;
+        const S h = S(dt);
         State k1 = f(t, x);
-        State k2 = f(t + 3. * dt / 4., x + 3. * dt * k1 / 4.);
-        State x_new = x + dt * (k1 / 3. + 2. * k2 / 3.);
+        State k2 = f(t + 3. * dt / 4., x + S(3. / 4.) * h * k1);
+        State x_new = x + h * (k1 / S(3) + S(2. / 3.) * k2);
         f64 t_new = t + dt;
         return {t_new, x_new};
     }
-};
\ No newline at end of file
+};
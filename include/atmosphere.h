@@ -0,0 +1,255 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "constants.h"
+#include "ephemeris.h"
+#include "eval_context.h"
+#include "typedefs.h"
+
+// -----------------------------------------------------------------------------
+// Atmospheric Density Models
+// -----------------------------------------------------------------------------
+// Density models provide density(t, r) in kg/m^3 for an inertial position r
+// (km). Altitude is measured above a spherical Earth. density is templated on
+// the scalar so drag can be differentiated with Dual numbers; bin and band
+// selection use the value only.
+
+// Exponential band: rho = rho0 * exp(-(h - h0) / H)
+struct ExpBand {
+    f64 h0;      // km
+    f64 ln_rho0; // ln(kg/m^3)
+    f64 inv_H;   // 1/km
+};
+
+// Piecewise exponential profile resampled onto uniform altitude bins so a
+// lookup is one index computation and one exp, no search. Band edges that
+// fall on bin edges (integer km for the default tables) are exact.
+struct AltitudeBandTable {
+    f64 h_min, h_max, inv_dh;
+    std::vector<ExpBand> bins;
+
+    // rows: {h0, rho0, H}, sorted by h0; the last row extends to h_max
+    AltitudeBandTable(
+        const std::vector<std::array<f64, 3>> &rows,
+        f64 h_max,
+        f64 dh = 1.
+    )
+        : h_min(rows.front()[0]), h_max(h_max), inv_dh(1. / dh) {
+        int N = static_cast<int>(std::ceil((h_max - h_min) * inv_dh)) + 1;
+        bins.reserve(N);
+        size_t j = 0;
+        for (int i = 0; i < N; i++) {
+            f64 h = h_min + i * dh;
+            while (j + 1 < rows.size() && rows[j + 1][0] <= h) {
+                j++;
+            }
+            bins.push_back({rows[j][0], std::log(rows[j][1]), 1. / rows[j][2]}
+            );
+        }
+    }
+
+    // Beyond either end the nearest band is extrapolated
+    template <typename S> S operator()(const S &h) const {
+        using std::exp;
+        int i = static_cast<int>((static_cast<f64>(h) - h_min) * inv_dh);
+        i = std::clamp(i, 0, static_cast<int>(bins.size()) - 1);
+        const ExpBand &b = bins[i];
+        return exp(b.ln_rho0 - (h - b.h0) * b.inv_H);
+    }
+};
+
+// Vallado Table 8-4 exponential model, 0-1000 km
+inline std::shared_ptr<const AltitudeBandTable> vallado_exponential_table() {
+    static const auto table = std::make_shared<const AltitudeBandTable>(
+        std::vector<std::array<f64, 3>>{
+            {0., 1.225, 7.249},        {25., 3.899e-2, 6.349},
+            {30., 1.774e-2, 6.682},    {40., 3.972e-3, 7.554},
+            {50., 1.057e-3, 8.382},    {60., 3.206e-4, 7.714},
+            {70., 8.770e-5, 6.549},    {80., 1.905e-5, 5.799},
+            {90., 3.396e-6, 5.382},    {100., 5.297e-7, 5.877},
+            {110., 9.661e-8, 7.263},   {120., 2.438e-8, 9.473},
+            {130., 8.484e-9, 12.636},  {140., 3.845e-9, 16.149},
+            {150., 2.070e-9, 22.523},  {180., 5.464e-10, 29.740},
+            {200., 2.789e-10, 37.105}, {250., 7.248e-11, 45.546},
+            {300., 2.418e-11, 53.628}, {350., 9.518e-12, 53.298},
+            {400., 3.725e-12, 58.515}, {450., 1.585e-12, 60.828},
+            {500., 6.967e-13, 63.822}, {600., 1.454e-13, 71.835},
+            {700., 3.614e-14, 88.667}, {800., 1.170e-14, 124.64},
+            {900., 5.245e-15, 181.05}, {1000., 3.019e-15, 268.00},
+        },
+        1000.
+    );
+    return table;
+}
+
+// Piecewise exponential (defaults to the Vallado table)
+struct ExponentialAtmosphere {
+    std::shared_ptr<const AltitudeBandTable> table;
+
+    explicit ExponentialAtmosphere(
+        std::shared_ptr<const AltitudeBandTable> table
+        = vallado_exponential_table()
+    )
+        : table(std::move(table)) {};
+
+    // r_mag = |r|, passed in when the caller already has it
+    template <typename S>
+    S density(f64 t, const vec3t<S> &r, const S &r_mag) const {
+        return (*table)(S(r_mag - r_earth));
+    }
+    template <typename S> S density(f64 t, const vec3t<S> &r) const {
+        return density<S>(t, r, r.norm());
+    }
+    f64 density(f64 t, const vec3 &r) const { return density<f64>(t, r); }
+};
+
+// Harris-Priester (Montenbruck & Gill, Table 3.8), mean solar activity,
+// 100-1000 km, zero outside. Rows are {h, rho_min, rho_max} in g/km^3.
+inline const std::vector<std::array<f64, 3>> &harris_priester_rows() {
+    static const std::vector<std::array<f64, 3>> rows{
+        {100., 497400.0, 497400.0}, {120., 24900.0, 24900.0},
+        {130., 8377.0, 8710.0},     {140., 3899.0, 4059.0},
+        {150., 2122.0, 2215.0},     {160., 1263.0, 1344.0},
+        {170., 800.8, 875.8},       {180., 528.3, 601.0},
+        {190., 361.7, 429.7},       {200., 255.7, 316.2},
+        {210., 183.9, 239.6},       {220., 134.1, 185.3},
+        {230., 99.49, 145.5},       {240., 74.88, 115.7},
+        {250., 57.09, 93.08},       {260., 44.03, 75.55},
+        {270., 34.30, 61.82},       {280., 26.97, 50.95},
+        {290., 21.39, 42.26},       {300., 17.08, 35.26},
+        {320., 10.99, 25.11},       {340., 7.214, 18.19},
+        {360., 4.824, 13.37},       {380., 3.274, 9.955},
+        {400., 2.249, 7.492},       {420., 1.558, 5.684},
+        {440., 1.091, 4.355},       {460., 0.7701, 3.362},
+        {480., 0.5474, 2.612},      {500., 0.3916, 2.042},
+        {520., 0.2819, 1.605},      {540., 0.2042, 1.267},
+        {560., 0.1488, 1.005},      {580., 0.1092, 0.8015},
+        {600., 0.08070, 0.6412},    {620., 0.06012, 0.5150},
+        {640., 0.04519, 0.4151},    {660., 0.03430, 0.3362},
+        {680., 0.02632, 0.2737},    {700., 0.02043, 0.2240},
+        {720., 0.01607, 0.1846},    {740., 0.01281, 0.1529},
+        {760., 0.01036, 0.1276},    {780., 0.008496, 0.1071},
+        {800., 0.007069, 0.09047},  {840., 0.004680, 0.06537},
+        {880., 0.003200, 0.04850},  {920., 0.002210, 0.03696},
+        {960., 0.001560, 0.02867},  {1000., 0.001150, 0.02252},
+    };
+    return rows;
+}
+
+// Convert {h, rho_min, rho_max} rows (g/km^3) into band rows {h0, rho0, H}
+// (kg/m^3) for column col (1 = min, 2 = max)
+inline std::vector<std::array<f64, 3>>
+harris_priester_bands(const std::vector<std::array<f64, 3>> &rows, int col) {
+    const f64 g_km3_to_kg_m3 = 1e-12;
+    std::vector<std::array<f64, 3>> bands;
+    for (size_t i = 0; i + 1 < rows.size(); i++) {
+        f64 H = (rows[i + 1][0] - rows[i][0])
+                / std::log(rows[i][col] / rows[i + 1][col]);
+        bands.push_back({rows[i][0], rows[i][col] * g_km3_to_kg_m3, H});
+    }
+    return bands;
+}
+
+struct HarrisPriesterAtmosphere {
+    static constexpr f64 h_lo = 100.;
+    static constexpr f64 h_hi = 1000.;
+    static constexpr f64 lag_deg = 30.; // bulge lag in right ascension
+
+    std::shared_ptr<const AltitudeBandTable> rho_min, rho_max;
+    std::shared_ptr<const UniformTable3> bulge; // apex unit vector
+    f64 half_n; // cos^n(psi/2) = ((1 + cos(psi)) / 2)^(n/2)
+
+    // n = 2 for low inclinations up to n = 6 for polar orbits
+    explicit HarrisPriesterAtmosphere(
+        const SunMoonEphemeris &eph,
+        f64 n = 4.
+    )
+        : half_n(n / 2.) {
+        static const auto min_table = std::make_shared<const AltitudeBandTable>(
+            harris_priester_bands(harris_priester_rows(), 1), h_hi
+        );
+        static const auto max_table = std::make_shared<const AltitudeBandTable>(
+            harris_priester_bands(harris_priester_rows(), 2), h_hi
+        );
+        rho_min = min_table;
+        rho_max = max_table;
+
+        // Apex of the diurnal bulge, Sun direction rotated by lag about z,
+        // sampled once on the ephemeris grid
+        const f64 c = std::cos(lag_deg * deg2rad);
+        const f64 s = std::sin(lag_deg * deg2rad);
+        bulge = std::make_shared<const UniformTable3>(
+            [&eph, c, s](f64 t) {
+                vec3 e_sun = eph.sun_position(t).normalized();
+                return vec3(
+                    c * e_sun(0) - s * e_sun(1),
+                    s * e_sun(0) + c * e_sun(1),
+                    e_sun(2)
+                );
+            },
+            eph.t0,
+            eph.tf,
+            eph.sun.h
+        );
+    }
+
+    template <typename S>
+    S density(f64 t, const vec3t<S> &r, const S &r_mag) const {
+        using std::pow;
+        S h = r_mag - r_earth;
+        f64 in_range = static_cast<f64>(h >= h_lo && h <= h_hi);
+
+        S cos_psi = r.dot((*bulge)(t).template cast<S>()) / r_mag;
+        S half_cos = 0.5 + 0.5 * cos_psi;
+        S w = half_cos > 0. ? pow(half_cos, half_n) : S(0.);
+        S lo = (*rho_min)(h);
+        S hi = (*rho_max)(h);
+        return in_range * (lo + (hi - lo) * w);
+    }
+    template <typename S> S density(f64 t, const vec3t<S> &r) const {
+        return density<S>(t, r, r.norm());
+    }
+    f64 density(f64 t, const vec3 &r) const { return density<f64>(t, r); }
+};
+
+// -----------------------------------------------------------------------------
+// Drag
+// -----------------------------------------------------------------------------
+
+// Cannonball drag relative to an atmosphere co-rotating with the Earth
+template <typename State, typename Atmosphere> struct DragPolicy {
+    Atmosphere atmosphere;
+    f64 ballistic; // Cd * A / m, m^2/kg
+
+    explicit DragPolicy(const Atmosphere &atm, f64 Cd, f64 area, f64 mass)
+        : atmosphere(atm), ballistic(Cd * area / mass) {};
+
+    template <typename X>
+    vec3t<scalar_t<X>> acceleration(EvalContext<X> &ctx) const {
+        using S = scalar_t<X>;
+        vec3t<S> r = ctx.r();
+        vec3t<S> v = ctx.v();
+
+        // v - omega_earth x r
+        vec3t<S> v_rel(
+            v(0) + omega_earth * r(1), v(1) - omega_earth * r(0), v(2)
+        );
+        S rho;
+        if constexpr (requires {
+                          atmosphere.template density<S>(ctx.t, r, S());
+                      }) {
+            rho = atmosphere.template density<S>(ctx.t, r, ctx.r_mag());
+        } else {
+            rho = atmosphere.template density<S>(ctx.t, r);
+        }
+
+        // kg/m^3 * m^2/kg * km^2/s^2 -> 1e3 km/s^2
+        vec3t<S> a = (-0.5e3 * ballistic) * rho * v_rel.norm() * v_rel;
+        return a;
+    }
+};
@@ -3,6 +3,7 @@
 #include "typedefs.h"
 #include "units.h"
 #include <array>
+#include <concepts>
 #include <vector>
 
 using std::array;
@@ -10,31 +11,71 @@ using std::vector;
 
 enum struct RotationalAxis { x = 1, y = 2, z = 3 };
 
-inline mat3
-single_axis_rotation(f64 angle, RotationalAxis axis, UnitsAngle units_in);
+// Angles are either typed quantities (Radians, Degrees, ...; the unit is
+// resolved at compile time) or raw values with a runtime UnitsAngle.
+// Routines on raw values are templated on the scalar type and instantiated
+// for f64 and f32 in attitude.cpp.
 
-inline mat3 skew(vec3 v);
+mat3 single_axis_rotation(Radians angle, RotationalAxis axis);
+template <std::floating_point T>
+mat3t<T> single_axis_rotation(
+    T angle,
+    RotationalAxis axis,
+    UnitsAngle units_in = UnitsAngle::RADIANS
+);
+
+template <std::floating_point T> mat3t<T> skew(const vec3t<T> &v);
 
 // euler param (quaternion)
-inline mat3 ep_to_dcm(const vec4 &ep);
-inline vec4 dcm_to_ep(const mat3 &R);
-inline vec4 ep_kde(vec4 &ep, vec3 &omega);
-inline vec3 omega_ode(vec3 omega, vec3 torque, mat3 I, mat3 I_inv);
+template <std::floating_point T> mat3t<T> ep_to_dcm(const vec4t<T> &ep);
+template <std::floating_point T> vec4t<T> dcm_to_ep(const mat3t<T> &R);
+template <std::floating_point T>
+vec4t<T> ep_kde(const vec4t<T> &ep, const vec3t<T> &omega);
+template <std::floating_point T>
+vec3t<T> omega_ode(
+    const vec3t<T> &omega,
+    const vec3t<T> &torque,
+    const mat3t<T> &I,
+    const mat3t<T> &I_inv,
+    bool I_diag = true
+);
 
 // euler angles
-inline mat3
-ea_to_dcm(const vec3 &angles, const vec3 &sequence, UnitsAngle units_in);
-inline vec4
-ea_to_ep(const vec3 &angles, const vec3 &sequence, UnitsAngle units_in);
+mat3 ea_to_dcm(const Radians3 &angles, const vec3 &sequence);
+template <std::floating_point T>
+mat3t<T> ea_to_dcm(
+    const vec3t<T> &angles,
+    const vec3 &sequence,
+    UnitsAngle units_in = UnitsAngle::RADIANS
+);
+vec4 ea_to_ep(const Radians3 &angles, const vec3 &sequence);
+template <std::floating_point T>
+vec4t<T> ea_to_ep(
+    const vec3t<T> &angles,
+    const vec3 &sequence,
+    UnitsAngle units_in = UnitsAngle::RADIANS
+);
 
 // principle rotation
-inline mat3 pr_to_dcm(const vec3 &axis, const f64 &angle, UnitsAngle units_in);
-inline vec4 pr_to_ep(const vec3 &axis, const f64 &angle, UnitsAngle units_in);
+mat3 pr_to_dcm(const vec3 &axis, Radians angle);
+template <std::floating_point T>
+mat3t<T> pr_to_dcm(
+    const vec3t<T> &axis,
+    const T &angle,
+    UnitsAngle units_in = UnitsAngle::RADIANS
+);
+vec4 pr_to_ep(const vec3 &axis, Radians angle);
+template <std::floating_point T>
+vec4t<T> pr_to_ep(
+    const vec3t<T> &axis,
+    const T &angle,
+    UnitsAngle units_in = UnitsAngle::RADIANS
+);
 
 // classical rodrigues param
-inline mat3 crp_to_dcm(const vec3 &crp);
-inline vec4 crp_to_ep(const vec3 &crp);
+template <std::floating_point T> mat3t<T> crp_to_dcm(const vec3t<T> &crp);
+template <std::floating_point T> vec4t<T> crp_to_ep(const vec3t<T> &crp);
 
 // modified rodrigues param
-inline mat3 mrp_to_dcm(const vec3 &crp);
-inline vec4 mrp_to_ep(const vec3 &crp);
+template <std::floating_point T> mat3t<T> mrp_to_dcm(const vec3t<T> &crp);
+template <std::floating_point T> vec4t<T> mrp_to_ep(const vec3t<T> &crp);
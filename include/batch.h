@@ -0,0 +1,95 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "registry.h"
+#include "simd.h"
+#include "typedefs.h"
+
+// -----------------------------------------------------------------------------
+// Batch Systems
+// -----------------------------------------------------------------------------
+// Registry systems on the runtime dispatched SIMD kernels (simd.h). The
+// members of a set are gathered into structure-of-arrays scratch, advanced
+// by the kernels across all entities at once and scattered back. Link the
+// SIMD_SOURCES from CMakeLists.txt.
+
+// Fixed RK4 step of every translating entity under point mass + J2 gravity
+// (the same model as NewtonianGravityPolicy + ZonalGravityPolicy to degree 2)
+struct BatchTranslation {
+    f64 mu;
+    f64 J2;
+    f64 R_cb;
+    std::vector<f64> buf; // reused between steps
+
+    BatchTranslation(f64 mu, f64 J2, f64 R_cb) : mu(mu), J2(J2), R_cb(R_cb) {};
+
+    void step(Registry &reg, f64 dt) {
+        const SimdKernels &K = simd_kernels();
+        const size_t n = reg.translating.size();
+        const size_t m = 6 * n; // [x, y, z, vx, vy, vz] per entity
+        buf.resize(6 * m);
+        f64 *y = buf.data();
+        f64 *k1 = y + m;
+        f64 *k2 = k1 + m;
+        f64 *k3 = k2 + m;
+        f64 *k4 = k3 + m;
+        f64 *ys = k4 + m;
+
+        for (size_t i = 0; i < n; i++) {
+            Entity e = reg.translating[i];
+            for (int c = 0; c < 3; c++) {
+                y[c * n + i] = reg.pos[e](c);
+                y[(3 + c) * n + i] = reg.vel[e](c);
+            }
+        }
+
+        // dy/dt = [v, a(r)]
+        auto f = [&](const f64 *x, f64 *dx) {
+            std::copy(x + 3 * n, x + m, dx);
+            K.gravity_j2(n, x, dx + 3 * n, mu, J2, R_cb);
+        };
+        f(y, k1);
+        K.axpy(m, 0.5 * dt, k1, y, ys);
+        f(ys, k2);
+        K.axpy(m, 0.5 * dt, k2, y, ys);
+        f(ys, k3);
+        K.axpy(m, dt, k3, y, ys);
+        f(ys, k4);
+        K.rk4_combine(m, dt, y, k1, k2, k3, k4, ys);
+
+        for (size_t i = 0; i < n; i++) {
+            Entity e = reg.translating[i];
+            for (int c = 0; c < 3; c++) {
+                reg.pos[e](c) = ys[c * n + i];
+                reg.vel[e](c) = ys[(3 + c) * n + i];
+            }
+        }
+    }
+};
+
+// Inertial to body DCMs of the rotating entities, R[i] for member i
+inline void body_dcms(
+    const Registry &reg,
+    std::vector<mat3> &R,
+    std::vector<f64> &buf
+) {
+    const size_t n = reg.rotating.size();
+    buf.resize(13 * n);
+    f64 *q = buf.data();
+    f64 *r = q + 4 * n;
+    for (size_t i = 0; i < n; i++) {
+        const vec4 &ep = reg.ep[reg.rotating[i]];
+        for (int c = 0; c < 4; c++) {
+            q[c * n + i] = ep(c);
+        }
+    }
+    simd_kernels().ep_to_dcm(n, q, r);
+    R.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        for (int j = 0; j < 9; j++) {
+            R[i](j / 3, j % 3) = r[j * n + i];
+        }
+    }
+}
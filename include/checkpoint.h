@@ -0,0 +1,317 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "typedefs.h"
+
+// -----------------------------------------------------------------------------
+// Checkpoint/Restart
+// -----------------------------------------------------------------------------
+// A checkpoint is the full integrator state at a segment boundary: t, x and
+// the step size the integrator would try next (dt_ for the adaptive
+// integrators). The integrators in this tree are one-step methods, so there
+// is no multistep history to save; the file version guards the layout if
+// one is added.
+//
+// Checkpoints are appended as fixed-size records to one file per model key
+// (<dir>/<key>.ckpt). The key is a hash of everything that defines the
+// model, so the files double as an on-disk cache: a run with the same
+// configuration resumes from the latest record, and a run that changes the
+// model only after t_change can start from the latest record of the old
+// model at or before t_change. A record cut short by a crash fails its
+// checksum and is ignored. Every record is kept by default; with a
+// max_records bound, older records are thinned to roughly geometric spacing
+// (the first record is always kept), so a long run can still restart near
+// an early t_change.
+//
+// Resuming from a checkpoint reproduces the checkpointed run bit for bit; it
+// can differ from an unsegmented run because the last step of each segment
+// is clipped to the boundary.
+
+template <typename State> struct Checkpoint {
+    f64 t;
+    f64 dt;
+    State x;
+};
+
+// FNV-1a over the bytes of the model configuration. Scalars and types
+// without padding are hashed as their bytes, ranges (vectors, strings) as
+// their size and elements. Structs with padding do not compile: their
+// padding bytes would change the key from run to run, so add their fields
+// one by one.
+struct ModelKey {
+    u64 hash = 14695981039346656037ull;
+
+    ModelKey &add(const void *data, size_t n) {
+        const u8 *p = static_cast<const u8 *>(data);
+        for (size_t i = 0; i < n; i++) {
+            hash = (hash ^ p[i]) * 1099511628211ull;
+        }
+        return *this;
+    }
+    template <typename T> ModelKey &add(const T &v) {
+        if constexpr (std::is_same_v<T, f32> || std::is_same_v<T, f64>) {
+            return add(&v, sizeof(T));
+        } else if constexpr (std::has_unique_object_representations_v<T>) {
+            return add(&v, sizeof(T));
+        } else if constexpr (requires { v.size(), v.begin(), v.end(); }) {
+            add(static_cast<u64>(v.size()));
+            for (const auto &e : v) {
+                add(e);
+            }
+            return *this;
+        } else {
+            static_assert(
+                sizeof(T) == 0,
+                "ModelKey: T may contain padding, add its fields instead"
+            );
+            return *this;
+        }
+    }
+};
+
+template <typename... Args> u64 model_key(const Args &...args) {
+    ModelKey k;
+    (k.add(args), ...);
+    return k.hash;
+}
+
+template <typename State> struct CheckpointStore {
+    static_assert(
+        State::SizeAtCompileTime != eig::Dynamic,
+        "checkpoint records need a fixed-size state"
+    );
+    using S = scalar_t<State>;
+    static constexpr int N = State::SizeAtCompileTime;
+    static constexpr char magic[8] = {'O', 'A', 'D', 'C', 'K', 'P', 'T', '1'};
+    static constexpr u32 version = 1;
+
+    // Record layout: t, dt, x, checksum
+    static constexpr size_t record_size
+        = 2 * sizeof(f64) + N * sizeof(S) + sizeof(u64);
+
+    struct Header {
+        char magic[8];
+        u32 version;
+        u32 n;
+        u32 scalar_size;
+        u32 pad;
+        u64 key;
+    };
+
+    std::filesystem::path dir;
+    size_t max_records; // per key, 0 = unbounded
+
+    explicit CheckpointStore(std::filesystem::path dir, size_t max_records = 0)
+        : dir(std::move(dir)), max_records(max_records) {
+        if (max_records > 0 && max_records < 8) {
+            throw std::runtime_error("max_records must be 0 or at least 8");
+        }
+        std::filesystem::create_directories(this->dir);
+    }
+
+    std::filesystem::path path(u64 key) const {
+        char name[32];
+        std::snprintf(
+            name, sizeof(name), "%016llx.ckpt", (unsigned long long)key
+        );
+        return dir / name;
+    }
+
+    // Appends c to the records of key. Once max_records are stored the file
+    // is rewritten with the first record, every other one of the older
+    // records and the latest quarter (into a temporary file renamed over the
+    // old one, so a crash leaves either file intact). Records that survive
+    // k rewrites are about 2^k apart.
+    void append(u64 key, const Checkpoint<State> &c) const {
+        std::filesystem::path p = path(key);
+        bool fresh = !std::filesystem::exists(p);
+        size_t count = 0;
+        if (!fresh) {
+            // Drop a partial record left by a crash so new records stay
+            // readable; a file cut short within its header starts over
+            size_t size = std::filesystem::file_size(p);
+            if (size > sizeof(Header)) {
+                count = (size - sizeof(Header)) / record_size;
+                std::filesystem::resize_file(
+                    p, sizeof(Header) + count * record_size
+                );
+            } else {
+                fresh = true;
+            }
+        }
+
+        if (max_records > 0 && count >= max_records) {
+            std::vector<Checkpoint<State>> old = load(key);
+            size_t n = old.size();
+            size_t recent = n - std::min(n, max_records / 4);
+            std::vector<Checkpoint<State>> keep;
+            for (size_t i = 0; i < n; i++) {
+                if (i == 0 || i >= recent || i % 2 == 1) {
+                    keep.push_back(old[i]);
+                }
+            }
+            keep.push_back(c);
+            std::filesystem::path tmp = p;
+            tmp += ".tmp";
+            write(tmp, key, keep, true);
+            std::filesystem::rename(tmp, p);
+        } else {
+            write(p, key, {c}, fresh);
+        }
+    }
+
+    // All intact records for key, in the order they were written
+    std::vector<Checkpoint<State>> load(u64 key) const {
+        std::vector<Checkpoint<State>> out;
+        std::ifstream file(path(key), std::ios::binary);
+        if (!file.is_open()) {
+            return out;
+        }
+
+        Header h;
+        if (!file.read(reinterpret_cast<char *>(&h), sizeof(h))) {
+            return out;
+        }
+        if (std::memcmp(h.magic, magic, sizeof(magic)) != 0
+            || h.version != version || h.n != u32(N)
+            || h.scalar_size != u32(sizeof(S)) || h.key != key) {
+            throw std::runtime_error(
+                "Checkpoint file does not match this run: "
+                + path(key).string()
+            );
+        }
+
+        char buf[record_size];
+        while (file.read(buf, record_size)) {
+            u64 sum;
+            std::memcpy(&sum, buf + record_size - sizeof(u64), sizeof(u64));
+            if (sum != ModelKey().add(buf, record_size - sizeof(u64)).hash) {
+                break;
+            }
+            Checkpoint<State> c;
+            std::memcpy(&c.t, buf, sizeof(f64));
+            std::memcpy(&c.dt, buf + sizeof(f64), sizeof(f64));
+            std::memcpy(c.x.data(), buf + 2 * sizeof(f64), N * sizeof(S));
+            out.push_back(c);
+        }
+        return out;
+    }
+
+    // Latest checkpoint at or before t_change (default: the latest one)
+    std::optional<Checkpoint<State>> resume_point(
+        u64 key,
+        f64 t_change = std::numeric_limits<f64>::infinity()
+    ) const {
+        std::optional<Checkpoint<State>> best;
+        for (const Checkpoint<State> &c : load(key)) {
+            if (c.t <= t_change && (!best || c.t > best->t)) {
+                best = c;
+            }
+        }
+        return best;
+    }
+
+    void remove(u64 key) const { std::filesystem::remove(path(key)); }
+
+  private:
+    // Writes records to p, after a new header when fresh (p is truncated)
+    void write(
+        const std::filesystem::path &p,
+        u64 key,
+        const std::vector<Checkpoint<State>> &records,
+        bool fresh
+    ) const {
+        std::ofstream file(
+            p, std::ios::binary | (fresh ? std::ios::trunc : std::ios::app)
+        );
+        if (!file.is_open()) {
+            throw std::runtime_error("Could not open " + p.string());
+        }
+        if (fresh) {
+            Header h{{}, version, u32(N), u32(sizeof(S)), 0, key};
+            std::memcpy(h.magic, magic, sizeof(magic));
+            file.write(reinterpret_cast<const char *>(&h), sizeof(h));
+        }
+
+        for (const Checkpoint<State> &c : records) {
+            char buf[record_size];
+            std::memcpy(buf, &c.t, sizeof(f64));
+            std::memcpy(buf + sizeof(f64), &c.dt, sizeof(f64));
+            std::memcpy(buf + 2 * sizeof(f64), c.x.data(), N * sizeof(S));
+            u64 sum = ModelKey().add(buf, record_size - sizeof(u64)).hash;
+            std::memcpy(buf + record_size - sizeof(u64), &sum, sizeof(u64));
+            file.write(buf, record_size);
+        }
+        file.flush();
+        if (!file) {
+            throw std::runtime_error("Could not write " + p.string());
+        }
+    }
+};
+
+// Integrate t0 -> tf in segments of length interval, appending a checkpoint
+// under key at the end of each segment. Given a start checkpoint the run
+// picks up from it (t0 and x0 are then only used if start is empty) and the
+// output sequences begin at the checkpoint time.
+template <
+    typename Integrator,
+    typename State,
+    typename TimeSeq,
+    typename StateSeq>
+void integrate_checkpointed(
+    Integrator &integ,
+    f64 t0,
+    f64 tf,
+    const State &x0,
+    TimeSeq &times,
+    StateSeq &states,
+    const CheckpointStore<State> &store,
+    u64 key,
+    f64 interval,
+    const std::optional<Checkpoint<State>> &start = std::nullopt
+) {
+    f64 t = start ? start->t : t0;
+    State x = start ? start->x : x0;
+    if constexpr (requires { integ.dt_; }) {
+        if (start) {
+            integ.dt_ = start->dt;
+        }
+    }
+
+    times.clear();
+    states.clear();
+    times.push_back(t);
+    states.push_back(x);
+
+    std::vector<f64> seg_times;
+    std::vector<State> seg_states;
+    while (t < tf) {
+        f64 t_next = std::min(t + interval, tf);
+        integ.integrate(t, t_next, x, seg_times, seg_states);
+        for (size_t i = 1; i < seg_times.size(); i++) {
+            times.push_back(seg_times[i]);
+            states.push_back(seg_states[i]);
+        }
+        t = seg_times.back();
+        x = seg_states.back();
+
+        f64 dt;
+        if constexpr (requires { integ.dt_; }) {
+            dt = integ.dt_;
+        } else {
+            dt = integ.dt0_;
+        }
+        store.append(key, {t, dt, x});
+    }
+}
@@ -0,0 +1,399 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "constants.h"
+#include "parallel.h"
+#include "typedefs.h"
+
+// -----------------------------------------------------------------------------
+// Conjunction Screening
+// -----------------------------------------------------------------------------
+// Screens a propagated catalog for close approaches. All objects are sampled
+// on a common time grid (states[object][sample], position and velocity).
+// Candidates come from a uniform spatial hash grid per sample, which keeps the
+// work near O(N) per sample instead of O(N^2). Each candidate pair then passes
+// through the apogee/perigee shell and orbit path filters before its time of
+// closest approach is refined between samples by root finding on the range
+// rate. Time windows of samples are screened in parallel.
+
+struct ScreeningConfig {
+    f64 threshold = 5.;    // km, report encounters closer than this
+    f64 pad = 10.;         // km, slack for the orbit filters (perturbations)
+    f64 mu = mu_earth;     // for the osculating orbit filters
+    int window_steps = 32; // samples per parallel time window
+    int n_threads = 0;     // 0 = all cores
+};
+
+struct Conjunction {
+    int i, j;  // object indices, i < j
+    f64 tca;   // time of closest approach
+    f64 miss;  // miss distance, km
+    f64 v_rel; // relative speed at tca, km/s
+};
+
+// Osculating orbit geometry for the pair filters
+struct OrbitShell {
+    f64 rp, ra; // perigee/apogee radius (ra = inf if not elliptic)
+    f64 p;      // semi-latus rectum
+    vec3 h_hat; // orbit normal
+    vec3 e_vec; // eccentricity vector
+};
+
+inline OrbitShell orbit_shell(const vec6 &x, f64 mu) {
+    vec3 r = x.head<3>();
+    vec3 v = x.segment<3>(3);
+    vec3 h = r.cross(v);
+    vec3 e_vec = v.cross(h) / mu - r.normalized();
+    f64 e = e_vec.norm();
+    f64 p = h.squaredNorm() / mu;
+
+    OrbitShell s;
+    s.rp = p / (1. + e);
+    s.ra = e < 1. ? p / (1. - e) : std::numeric_limits<f64>::infinity();
+    s.p = p;
+    s.h_hat = h.normalized();
+    s.e_vec = e_vec;
+    return s;
+}
+
+// Apogee/perigee filter: radial shells separated by more than D never meet
+inline bool shells_overlap(const OrbitShell &a, const OrbitShell &b, f64 D) {
+    return std::max(a.rp, b.rp) - std::min(a.ra, b.ra) <= D;
+}
+
+// Radius range of an orbit over true anomalies nu0 - w .. nu0 + w (w <= pi),
+// with r = p / (1 + e cos nu); ra = inf where the orbit does not reach
+inline std::pair<f64, f64>
+radius_range(const OrbitShell &s, f64 nu0, f64 w) {
+    f64 e = s.e_vec.norm();
+    f64 c_lo = std::min(std::cos(nu0 - w), std::cos(nu0 + w));
+    f64 c_hi = std::max(std::cos(nu0 - w), std::cos(nu0 + w));
+    // cos peaks at nu = 0 and bottoms out at nu = pi inside the window
+    f64 d0 = std::remainder(nu0, twopi);
+    f64 dpi = std::remainder(nu0 - pi, twopi);
+    if (std::abs(d0) <= w) {
+        c_hi = 1.;
+    }
+    if (std::abs(dpi) <= w) {
+        c_lo = -1.;
+    }
+    f64 r_lo = s.p / (1. + e * c_hi);
+    f64 r_hi = 1. + e * c_lo > 0. ? s.p / (1. + e * c_lo)
+                                  : std::numeric_limits<f64>::infinity();
+    return {r_lo, r_hi};
+}
+
+// Orbit path filter: points of the two orbits within D of each other are
+// each within D of the other orbit's plane. A point at radius r and angle u
+// from the line of nodes k is r |sin u| sin(i) from the other plane, so both
+// points lie within asin(D / (rp sin i)) of a node. Compare the radius ranges
+// of the two orbits over those windows at each node. With windows of pi/4 or
+// more the planes are too close to tell apart and the pair passes.
+inline bool paths_overlap(const OrbitShell &a, const OrbitShell &b, f64 D) {
+    vec3 k = a.h_hat.cross(b.h_hat);
+    f64 k_mag = k.norm(); // sin of the relative inclination
+    f64 wa = D / (a.rp * k_mag);
+    f64 wb = D / (b.rp * k_mag);
+    if (!(std::max(wa, wb) < std::sin(pi / 4.))) {
+        return true;
+    }
+    k /= k_mag;
+    wa = std::asin(wa);
+    wb = std::asin(wb);
+
+    // True anomaly of the node direction k in each orbit
+    auto anomaly = [&k](const OrbitShell &s) {
+        f64 e = s.e_vec.norm();
+        if (e == 0.) {
+            return 0.;
+        }
+        vec3 e_hat = s.e_vec / e;
+        return std::atan2(s.h_hat.cross(e_hat).dot(k), e_hat.dot(k));
+    };
+    f64 nu_a = anomaly(a);
+    f64 nu_b = anomaly(b);
+
+    for (f64 node : {0., pi}) {
+        auto [a_lo, a_hi] = radius_range(a, nu_a + node, wa);
+        auto [b_lo, b_hi] = radius_range(b, nu_b + node, wb);
+        if (a_lo - b_hi <= D && b_lo - a_hi <= D) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Cubic Hermite interpolation of a state between two samples, s in [0, 1]
+inline vec6 hermite_state(const vec6 &x0, const vec6 &x1, f64 h, f64 s) {
+    f64 s2 = s * s;
+    f64 s3 = s2 * s;
+    f64 h00 = 2. * s3 - 3. * s2 + 1.;
+    f64 h10 = s3 - 2. * s2 + s;
+    f64 h01 = -2. * s3 + 3. * s2;
+    f64 h11 = s3 - s2;
+    f64 d00 = 6. * s2 - 6. * s;
+    f64 d10 = 3. * s2 - 4. * s + 1.;
+    f64 d01 = -6. * s2 + 6. * s;
+    f64 d11 = 3. * s2 - 2. * s;
+
+    vec3 r0 = x0.head<3>(), v0 = x0.segment<3>(3);
+    vec3 r1 = x1.head<3>(), v1 = x1.segment<3>(3);
+
+    vec6 x;
+    x << h00 * r0 + h10 * h * v0 + h01 * r1 + h11 * h * v1,
+        (d00 * r0 + d01 * r1) / h + d10 * v0 + d11 * v1;
+    return x;
+}
+
+// Range rate sign function, d/dt |dr|^2 / 2
+inline f64 range_rate(const vec6 &dx) {
+    return dx.head<3>().dot(dx.segment<3>(3));
+}
+
+// Closest approach of a relative trajectory between two samples. Returns the
+// fraction s in [0, 1] where the range rate crosses from negative to
+// positive, or -1 if it does not (Illinois false position).
+inline f64 tca_fraction(const vec6 &dx0, const vec6 &dx1, f64 h) {
+    f64 g0 = range_rate(dx0);
+    f64 g1 = range_rate(dx1);
+    if (!(g0 < 0. && g1 >= 0.)) {
+        return -1.;
+    }
+
+    f64 a = 0., b = 1.;
+    int side = 0;
+    f64 s = 0.;
+    for (int it = 0; it < 60; it++) {
+        s = (a * g1 - b * g0) / (g1 - g0);
+        f64 g = range_rate(hermite_state(dx0, dx1, h, s));
+        if (std::abs(g) < 1e-12 || (b - a) * h < 1e-6) {
+            break;
+        }
+        if (g < 0.) {
+            a = s;
+            g0 = g;
+            if (side == -1) {
+                g1 *= 0.5;
+            }
+            side = -1;
+        } else {
+            b = s;
+            g1 = g;
+            if (side == 1) {
+                g0 *= 0.5;
+            }
+            side = 1;
+        }
+    }
+    return s;
+}
+
+namespace detail {
+
+// Cell key, 21 bits per axis
+inline u64 cell_key(i64 ix, i64 iy, i64 iz) {
+    const i64 off = 1 << 20;
+    const u64 mask = (1u << 21) - 1;
+    return (static_cast<u64>(ix + off) & mask) << 42
+           | (static_cast<u64>(iy + off) & mask) << 21
+           | (static_cast<u64>(iz + off) & mask);
+}
+
+// Uniform grid of cubic cells, objects sorted by cell key with a key -> range
+// map for O(1) neighbour cell lookup. Buffers are reused between builds.
+struct SpatialHash {
+    f64 inv_cell;
+    std::vector<std::pair<u64, int>> entries;
+    std::unordered_map<u64, std::pair<int, int>> ranges;
+
+    explicit SpatialHash(f64 cell) : inv_cell(1. / cell) {};
+
+    Eigen::Vector3<i64> cell_of(const vec3 &r) const {
+        return (r * inv_cell).array().floor().cast<i64>();
+    }
+
+    void build(const std::vector<vec3> &pos) {
+        int N = static_cast<int>(pos.size());
+        entries.resize(N);
+        for (int i = 0; i < N; i++) {
+            auto c = cell_of(pos[i]);
+            entries[i] = {cell_key(c(0), c(1), c(2)), i};
+        }
+        std::sort(entries.begin(), entries.end());
+
+        ranges.clear();
+        for (int b = 0; b < N;) {
+            int e = b + 1;
+            while (e < N && entries[e].first == entries[b].first) {
+                e++;
+            }
+            ranges[entries[b].first] = {b, e};
+            b = e;
+        }
+    }
+
+    // fn(j) for every object in the 27 cells around r
+    template <typename Fn>
+    void for_each_neighbor(const vec3 &r, Fn &&fn) const {
+        auto c = cell_of(r);
+        for (int dx = -1; dx <= 1; dx++) {
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dz = -1; dz <= 1; dz++) {
+                    u64 key = cell_key(c(0) + dx, c(1) + dy, c(2) + dz);
+                    auto it = ranges.find(key);
+                    if (it == ranges.end()) {
+                        continue;
+                    }
+                    for (int q = it->second.first; q < it->second.second; q++) {
+                        fn(entries[q].second);
+                    }
+                }
+            }
+        }
+    }
+};
+
+// Refine a candidate flagged at sample k, searching the intervals on both
+// sides. Appends at most one encounter per interval.
+inline void refine_pair(
+    const std::vector<f64> &times,
+    const std::vector<vec6> &xi,
+    const std::vector<vec6> &xj,
+    int i,
+    int j,
+    int k,
+    f64 threshold,
+    std::vector<Conjunction> &out
+) {
+    int K = static_cast<int>(times.size());
+    auto record = [&](f64 t, const vec6 &dx) {
+        f64 miss = dx.head<3>().norm();
+        if (miss <= threshold) {
+            out.push_back({i, j, t, miss, dx.segment<3>(3).norm()});
+        }
+    };
+
+    for (int k0 = std::max(k - 1, 0); k0 <= std::min(k, K - 2); k0++) {
+        f64 h = times[k0 + 1] - times[k0];
+        vec6 dx0 = xj[k0] - xi[k0];
+        vec6 dx1 = xj[k0 + 1] - xi[k0 + 1];
+        f64 s = tca_fraction(dx0, dx1, h);
+        if (s >= 0.) {
+            record(times[k0] + s * h, hermite_state(dx0, dx1, h, s));
+        }
+    }
+
+    // Closest approach at the ends of the grid
+    if (k == 0 && K > 1 && range_rate(xj[0] - xi[0]) >= 0.) {
+        record(times[0], xj[0] - xi[0]);
+    }
+    if (k == K - 1 && K > 1 && range_rate(xj[k] - xi[k]) <= 0.) {
+        record(times[k], xj[k] - xi[k]);
+    }
+}
+
+} // namespace detail
+
+inline std::vector<Conjunction> screen_conjunctions(
+    const std::vector<f64> &times,
+    const std::vector<std::vector<vec6>> &states,
+    const ScreeningConfig &cfg = ScreeningConfig()
+) {
+    const int N = static_cast<int>(states.size());
+    const int K = static_cast<int>(times.size());
+    if (N < 2 || K == 0) {
+        return {};
+    }
+
+    // Hash distance: an approach within threshold between samples shows up
+    // within threshold + v_rel * dt / 2 at the nearest sample
+    f64 v_max = 0.;
+    f64 dt_max = 0.;
+    for (const auto &x : states) {
+        for (const auto &xk : x) {
+            v_max = std::max(v_max, xk.segment<3>(3).norm());
+        }
+    }
+    for (int k = 1; k < K; k++) {
+        dt_max = std::max(dt_max, times[k] - times[k - 1]);
+    }
+    const f64 D = cfg.threshold + v_max * dt_max;
+    const f64 D_filter = cfg.threshold + cfg.pad;
+
+    std::vector<OrbitShell> shells(N);
+    for (int i = 0; i < N; i++) {
+        shells[i] = orbit_shell(states[i][0], cfg.mu);
+    }
+
+    const int W = std::max(cfg.window_steps, 1);
+    const int n_windows = (K + W - 1) / W;
+    std::vector<std::vector<Conjunction>> found(n_windows);
+
+    parallel_for(
+        n_windows,
+        [&](int w) {
+            detail::SpatialHash grid(D);
+            std::vector<vec3> pos(N);
+            auto &out = found[w];
+
+            for (int k = w * W; k < std::min((w + 1) * W, K); k++) {
+                for (int i = 0; i < N; i++) {
+                    pos[i] = states[i][k].head<3>();
+                }
+                grid.build(pos);
+
+                for (int i = 0; i < N; i++) {
+                    grid.for_each_neighbor(pos[i], [&](int j) {
+                        if (j <= i || (pos[j] - pos[i]).norm() > D
+                            || !shells_overlap(shells[i], shells[j], D_filter)
+                            || !paths_overlap(shells[i], shells[j], D_filter)) {
+                            return;
+                        }
+                        detail::refine_pair(
+                            times,
+                            states[i],
+                            states[j],
+                            i,
+                            j,
+                            k,
+                            cfg.threshold,
+                            out
+                        );
+                    });
+                }
+            }
+        },
+        cfg.n_threads
+    );
+
+    // Merge windows; neighbouring samples report the same encounter
+    std::vector<Conjunction> all;
+    for (auto &f : found) {
+        all.insert(all.end(), f.begin(), f.end());
+    }
+    std::sort(all.begin(), all.end(), [](const auto &a, const auto &b) {
+        return std::tie(a.i, a.j, a.tca) < std::tie(b.i, b.j, b.tca);
+    });
+    std::vector<Conjunction> events;
+    for (const auto &c : all) {
+        if (!events.empty() && events.back().i == c.i && events.back().j == c.j
+            && c.tca - events.back().tca < dt_max) {
+            if (c.miss < events.back().miss) {
+                events.back() = c;
+            }
+            continue;
+        }
+        events.push_back(c);
+    }
+    std::sort(events.begin(), events.end(), [](const auto &a, const auto &b) {
+        return a.tca < b.tca;
+    });
+    return events;
+}
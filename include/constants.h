@@ -4,13 +4,13 @@
 #include <math.h>
 
 // global constants
-const f64 pi = 3.14159265358979323846;
-const f64 twopi = 2. * pi;
-const f64 pio2 = pi / 2.;
-const f64 pio4 = pi / 4.;
-const f64 pio8 = pi / 8.;
-const f64 rad2deg = 180. / pi;
-const f64 deg2rad = pi / 180;
+constexpr f64 pi = 3.14159265358979323846;
+constexpr f64 twopi = 2. * pi;
+constexpr f64 pio2 = pi / 2.;
+constexpr f64 pio4 = pi / 4.;
+constexpr f64 pio8 = pi / 8.;
+constexpr f64 rad2deg = 180. / pi;
+constexpr f64 deg2rad = pi / 180;
 
 const f64 sqrt2 = sqrt(2.);
 const f64 sqrt2inv = 1. / sqrtf(2.);
@@ -23,3 +23,15 @@ const f64 u2rl = 1. / rl2u;
 const f64 gravity_constant = 6.67259e-20; // km3*kg-1*s-2
 
 const f64 speed_light = 2.99792e5; // km*s-1
+const f64 p_solar = 4.56e-6;       // N*m-2 at 1 au
+
+const f64 au = 149597870.7;          // km
+const f64 r_earth = 6378.137;        // km
+const f64 r_sun = 696000.;           // km
+const f64 mu_earth = 398600.4418;    // km3*s-2
+const f64 mu_sun = 1.32712440018e11; // km3*s-2
+const f64 mu_moon = 4902.800066;     // km3*s-2
+const f64 omega_earth = 7.292115e-5; // rad*s-1
+
+const f64 jd_j2000 = 2451545.0;
+const f64 sec_per_day = 86400.;
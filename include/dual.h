@@ -0,0 +1,223 @@
+#pragma once
+
+#include <cmath>
+
+#include "typedefs.h"
+
+// -----------------------------------------------------------------------------
+// Forward Mode Automatic Differentiation
+// -----------------------------------------------------------------------------
+// Dual<N> carries a value and N tangents. The tangents live in a fixed-size
+// Eigen array, so every operation updates all N lanes with one vectorized
+// expression. Seeding the 6 state components as independent variables gives
+// the full 3x6 acceleration Jacobian from a single force model evaluation.
+//
+// Math functions are found by ADL; generic code should call them unqualified
+// after e.g. `using std::sqrt;`. Comparisons and explicit conversion to f64
+// act on the value only, so branches pick the same side as the f64 code.
+
+template <int N> struct Dual {
+    using Tangent = eig::Array<f64, N, 1>;
+
+    f64 v;
+    Tangent d;
+
+    Dual() : v(0.), d(Tangent::Zero()) {};
+    Dual(f64 v) : v(v), d(Tangent::Zero()) {};
+    Dual(f64 v, const Tangent &d) : v(v), d(d) {};
+
+    // Independent variable i
+    static Dual variable(f64 v, int i) {
+        Dual x(v);
+        x.d(i) = 1.;
+        return x;
+    }
+
+    explicit operator f64() const { return v; }
+
+    Dual &operator+=(const Dual &b) {
+        v += b.v;
+        d += b.d;
+        return *this;
+    }
+    Dual &operator-=(const Dual &b) {
+        v -= b.v;
+        d -= b.d;
+        return *this;
+    }
+    Dual &operator*=(const Dual &b) {
+        d = d * b.v + v * b.d;
+        v *= b.v;
+        return *this;
+    }
+    Dual &operator/=(const Dual &b) {
+        f64 inv = 1. / b.v;
+        v *= inv;
+        d = (d - v * b.d) * inv;
+        return *this;
+    }
+};
+
+// Arithmetic
+template <int N> Dual<N> operator-(const Dual<N> &a) { return {-a.v, -a.d}; }
+template <int N> Dual<N> operator+(const Dual<N> &a) { return a; }
+
+template <int N> Dual<N> operator+(const Dual<N> &a, const Dual<N> &b) {
+    return {a.v + b.v, a.d + b.d};
+}
+template <int N> Dual<N> operator+(const Dual<N> &a, f64 b) {
+    return {a.v + b, a.d};
+}
+template <int N> Dual<N> operator+(f64 a, const Dual<N> &b) {
+    return {a + b.v, b.d};
+}
+
+template <int N> Dual<N> operator-(const Dual<N> &a, const Dual<N> &b) {
+    return {a.v - b.v, a.d - b.d};
+}
+template <int N> Dual<N> operator-(const Dual<N> &a, f64 b) {
+    return {a.v - b, a.d};
+}
+template <int N> Dual<N> operator-(f64 a, const Dual<N> &b) {
+    return {a - b.v, -b.d};
+}
+
+template <int N> Dual<N> operator*(const Dual<N> &a, const Dual<N> &b) {
+    return {a.v * b.v, a.d * b.v + a.v * b.d};
+}
+template <int N> Dual<N> operator*(const Dual<N> &a, f64 b) {
+    return {a.v * b, a.d * b};
+}
+template <int N> Dual<N> operator*(f64 a, const Dual<N> &b) {
+    return {a * b.v, a * b.d};
+}
+
+template <int N> Dual<N> operator/(const Dual<N> &a, const Dual<N> &b) {
+    f64 inv = 1. / b.v;
+    f64 q = a.v * inv;
+    return {q, (a.d - q * b.d) * inv};
+}
+template <int N> Dual<N> operator/(const Dual<N> &a, f64 b) {
+    f64 inv = 1. / b;
+    return {a.v * inv, a.d * inv};
+}
+template <int N> Dual<N> operator/(f64 a, const Dual<N> &b) {
+    f64 inv = 1. / b.v;
+    f64 q = a * inv;
+    return {q, -q * inv * b.d};
+}
+
+// Comparisons (value only)
+#define DUAL_COMPARISON(OP)                                                    \
+    template <int N> bool operator OP(const Dual<N> &a, const Dual<N> &b) {    \
+        return a.v OP b.v;                                                     \
+    }                                                                          \
+    template <int N> bool operator OP(const Dual<N> &a, f64 b) {               \
+        return a.v OP b;                                                       \
+    }                                                                          \
+    template <int N> bool operator OP(f64 a, const Dual<N> &b) {               \
+        return a OP b.v;                                                       \
+    }
+DUAL_COMPARISON(<)
+DUAL_COMPARISON(<=)
+DUAL_COMPARISON(>)
+DUAL_COMPARISON(>=)
+DUAL_COMPARISON(==)
+DUAL_COMPARISON(!=)
+#undef DUAL_COMPARISON
+
+// Elementary functions: value f(v), tangents f'(v) * d
+template <int N> Dual<N> sqrt(const Dual<N> &a) {
+    f64 s = std::sqrt(a.v);
+    return {s, a.d * (0.5 / s)};
+}
+template <int N> Dual<N> abs(const Dual<N> &a) { return a.v < 0. ? -a : a; }
+template <int N> Dual<N> exp(const Dual<N> &a) {
+    f64 e = std::exp(a.v);
+    return {e, a.d * e};
+}
+template <int N> Dual<N> log(const Dual<N> &a) {
+    return {std::log(a.v), a.d / a.v};
+}
+template <int N> Dual<N> pow(const Dual<N> &a, f64 n) {
+    f64 p = std::pow(a.v, n - 1.);
+    return {p * a.v, a.d * (n * p)};
+}
+template <int N> Dual<N> sin(const Dual<N> &a) {
+    return {std::sin(a.v), a.d * std::cos(a.v)};
+}
+template <int N> Dual<N> cos(const Dual<N> &a) {
+    return {std::cos(a.v), a.d * -std::sin(a.v)};
+}
+template <int N> Dual<N> tanh(const Dual<N> &a) {
+    f64 th = std::tanh(a.v);
+    return {th, a.d * (1. - th * th)};
+}
+template <int N> Dual<N> atan2(const Dual<N> &y, const Dual<N> &x) {
+    f64 inv = 1. / (x.v * x.v + y.v * y.v);
+    return {std::atan2(y.v, x.v), (x.v * y.d - y.v * x.d) * inv};
+}
+
+// Eigen scalar support
+namespace Eigen {
+template <int N> struct NumTraits<Dual<N>> : GenericNumTraits<Dual<N>> {
+    using Real = Dual<N>;
+    using NonInteger = Dual<N>;
+    using Literal = f64;
+    using Nested = Dual<N>;
+    enum {
+        IsComplex = 0,
+        IsInteger = 0,
+        IsSigned = 1,
+        RequireInitialization = 1,
+        ReadCost = N + 1,
+        AddCost = N + 1,
+        MulCost = 2 * N + 1,
+    };
+    static inline Real epsilon() { return NumTraits<f64>::epsilon(); }
+    static inline Real dummy_precision() {
+        return NumTraits<f64>::dummy_precision();
+    }
+    static inline Real highest() { return NumTraits<f64>::highest(); }
+    static inline Real lowest() { return NumTraits<f64>::lowest(); }
+    static inline int digits10() { return NumTraits<f64>::digits10(); }
+};
+
+// Allow f64 * Matrix<Dual> and friends
+template <int N, typename BinaryOp>
+struct ScalarBinaryOpTraits<Dual<N>, f64, BinaryOp> {
+    using ReturnType = Dual<N>;
+};
+template <int N, typename BinaryOp>
+struct ScalarBinaryOpTraits<f64, Dual<N>, BinaryOp> {
+    using ReturnType = Dual<N>;
+};
+} // namespace Eigen
+
+// Seed an f64 state as N independent variables
+template <int N>
+eig::Matrix<Dual<N>, N, 1> dual_variables(const eig::Matrix<f64, N, 1> &x) {
+    eig::Matrix<Dual<N>, N, 1> xd;
+    for (int i = 0; i < N; i++) {
+        xd(i) = Dual<N>::variable(x(i), i);
+    }
+    return xd;
+}
+
+// Values and Jacobian (rows = outputs) of a dual vector
+template <int M, int N>
+eig::Matrix<f64, M, 1> dual_values(const eig::Matrix<Dual<N>, M, 1> &y) {
+    eig::Matrix<f64, M, 1> v;
+    for (int i = 0; i < M; i++) {
+        v(i) = y(i).v;
+    }
+    return v;
+}
+template <int M, int N>
+eig::Matrix<f64, M, N> dual_jacobian(const eig::Matrix<Dual<N>, M, 1> &y) {
+    eig::Matrix<f64, M, N> J;
+    for (int i = 0; i < M; i++) {
+        J.row(i) = y(i).d.matrix().transpose();
+    }
+    return J;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+
+#include "CelestialBody.h"
+#include "egm_tables.h" // generated, see cmake/EmbedGravityModels.cmake
+
+// -----------------------------------------------------------------------------
+// Embedded Gravity Models
+// -----------------------------------------------------------------------------
+// Every model file present in assets/ at configure time is compiled in to
+// degree EmbeddedGravityModel::max_degree, so short runs need no model file
+// and do not depend on the working directory. Higher degrees still go
+// through EGMCoefficients::load_egm.
+
+// Embedded table for a model year (1984, 1996, 2008)
+inline const EmbeddedGravityModel &embedded_gravity_model(int year) {
+    for (const EmbeddedGravityModel *model : embedded_gravity_models) {
+        if (model->year == year) {
+            return *model;
+        }
+    }
+    std::string have;
+    for (const EmbeddedGravityModel *model : embedded_gravity_models) {
+        have += (have.empty() ? "" : ", ") + std::to_string(model->year);
+    }
+    throw std::runtime_error(
+        "Gravity Model year " + std::to_string(year)
+        + " is not embedded (embedded: " + (have.empty() ? "none" : have)
+        + "), add its file to assets/ and reconfigure"
+    );
+}
+
+// Coefficients to degree N, order M of an embedded model
+inline EGMCoefficients embedded_egm(int year, int N, int M) {
+    return EGMCoefficients(embedded_gravity_model(year), N, M);
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "constants.h"
+#include "typedefs.h"
+
+// -----------------------------------------------------------------------------
+// Analytic Sun/Moon Ephemerides (Vallado, Algorithms 29 and 31)
+// -----------------------------------------------------------------------------
+// Low precision series in the mean equator/equinox of date, positions in km.
+// Accuracy is ~0.01 deg for the Sun and ~0.3 deg for the Moon, which is
+// adequate for point mass perturbations.
+
+inline vec3 sun_position_analytic(f64 jd) {
+    f64 T = (jd - jd_j2000) / 36525.;
+    f64 lambda_M = (280.460 + 36000.771 * T) * deg2rad;
+    f64 M = (357.5291092 + 35999.05034 * T) * deg2rad;
+    f64 lambda = lambda_M + (1.914666471 * sin(M) + 0.019994643 * sin(2. * M))
+                                * deg2rad;
+    f64 r = (1.000140612 - 0.016708617 * cos(M) - 0.000139589 * cos(2. * M))
+            * au;
+    f64 eps = (23.439291 - 0.0130042 * T) * deg2rad;
+
+    return r * vec3(cos(lambda), cos(eps) * sin(lambda), sin(eps) * sin(lambda));
+}
+
+inline vec3 moon_position_analytic(f64 jd) {
+    f64 T = (jd - jd_j2000) / 36525.;
+    auto s = [](f64 deg) { return sin(deg * deg2rad); };
+    auto c = [](f64 deg) { return cos(deg * deg2rad); };
+
+    f64 lambda = (218.32 + 481267.8813 * T + 6.29 * s(134.9 + 477198.85 * T)
+                  - 1.27 * s(259.2 - 413335.38 * T)
+                  + 0.66 * s(235.7 + 890534.23 * T)
+                  + 0.21 * s(269.9 + 954397.70 * T)
+                  - 0.19 * s(357.5 + 35999.05 * T)
+                  - 0.11 * s(186.6 + 966404.05 * T))
+                 * deg2rad;
+    f64 phi = (5.13 * s(93.3 + 483202.03 * T) + 0.28 * s(228.2 + 960400.87 * T)
+               - 0.28 * s(318.3 + 6003.18 * T) - 0.17 * s(217.6 - 407332.20 * T))
+              * deg2rad;
+    f64 P = (0.9508 + 0.0518 * c(134.9 + 477198.85 * T)
+             + 0.0095 * c(259.2 - 413335.38 * T)
+             + 0.0078 * c(235.7 + 890534.23 * T)
+             + 0.0028 * c(269.9 + 954397.70 * T))
+            * deg2rad;
+    f64 eps = (23.439291 - 0.0130042 * T) * deg2rad;
+    f64 r = r_earth / sin(P);
+
+    return r
+           * vec3(
+               cos(phi) * cos(lambda),
+               cos(eps) * cos(phi) * sin(lambda) - sin(eps) * sin(phi),
+               sin(eps) * cos(phi) * sin(lambda) + cos(eps) * sin(phi)
+           );
+}
+
+// -----------------------------------------------------------------------------
+// Interpolated Ephemeris Cache
+// -----------------------------------------------------------------------------
+
+// Uniformly sampled table of fixed-size vectors (vec3 for positions) with 4
+// point (cubic) Lagrange interpolation. Lookup is O(1): the node index comes
+// straight from the time offset.
+template <typename V> struct UniformTable {
+    f64 t0, h, inv_h;
+    std::vector<V> nodes; // nodes[i] at t0 + (i - 1) * h
+
+    UniformTable() : t0(0.), h(1.), inv_h(1.) {};
+
+    template <typename Fn>
+    UniformTable(Fn fn, f64 t0, f64 tf, f64 h)
+        : t0(t0), h(h), inv_h(1. / h) {
+        // One node of padding before t0, two after tf (tf < t0 samples
+        // around t0 only)
+        f64 span = std::max(tf - t0, 0.);
+        int N = static_cast<int>(std::ceil(span * inv_h)) + 4;
+        nodes.reserve(N);
+        for (int i = 0; i < N; i++) {
+            nodes.push_back(fn(t0 + (i - 1) * h));
+        }
+    }
+
+    V operator()(f64 t) const {
+        f64 x = (t - t0) * inv_h;
+        // Outside the span the end polynomials are extrapolated
+        int i = std::clamp(
+            static_cast<int>(std::floor(x)),
+            0,
+            static_cast<int>(nodes.size()) - 4
+        );
+        f64 u = x - i;
+        f64 um1 = u - 1.;
+        f64 um2 = u - 2.;
+        f64 up1 = u + 1.;
+
+        const V *p = nodes.data() + i;
+        return (-u * um1 * um2 / 6.) * p[0] + (up1 * um1 * um2 / 2.) * p[1]
+               + (-up1 * u * um2 / 2.) * p[2] + (up1 * u * um1 / 6.) * p[3];
+    }
+};
+
+using UniformTable3 = UniformTable<vec3>;
+
+enum class ThirdBody { SUN, MOON };
+
+// Sun and Moon positions sampled once over [t0, tf] (seconds past jd0) and
+// interpolated at every force evaluation. Immutable after construction, so a
+// single instance can be shared by every satellite (and thread) in a batch.
+struct SunMoonEphemeris {
+    f64 jd0;    // Julian date at t = 0
+    f64 t0, tf; // sampled span
+    UniformTable3 sun, moon;
+
+    SunMoonEphemeris(
+        f64 jd0,
+        f64 t0,
+        f64 tf,
+        f64 dt_sun = sec_per_day / 4.,
+        f64 dt_moon = 3600.
+    )
+        : jd0(jd0), t0(t0), tf(tf),
+          sun(
+              [jd0](f64 t) {
+                  return sun_position_analytic(jd0 + t / sec_per_day);
+              },
+              t0,
+              tf,
+              dt_sun
+          ),
+          moon(
+              [jd0](f64 t) {
+                  return moon_position_analytic(jd0 + t / sec_per_day);
+              },
+              t0,
+              tf,
+              dt_moon
+          ) {};
+
+    vec3 sun_position(f64 t) const { return sun(t); }
+    vec3 moon_position(f64 t) const { return moon(t); }
+    vec3 position(ThirdBody body, f64 t) const {
+        return body == ThirdBody::SUN ? sun(t) : moon(t);
+    }
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cmath>
+#include <optional>
+
+#include "attitude.h"
+#include "constants.h"
+#include "ephemeris.h"
+#include "frames.h"
+#include "typedefs.h"
+
+// -----------------------------------------------------------------------------
+// Evaluation Context
+// -----------------------------------------------------------------------------
+// ForcePolicy3D builds one context per acceleration call (one RK stage) and
+// hands it to every policy. Derived quantities that several policies need are
+// computed on first use and memoized for the rest of the call, so |r|,
+// 1/|r|^3, the body DCM, the ECEF rotation and the Sun vector are each
+// evaluated at most once per stage however many policies ask for them.
+//
+// The memoized values assume every policy asks with the same inputs: one
+// ephemeris for sun() and one Earth model (FrameCache or gmst0) for
+// ecef_rotation().
+
+template <typename X> struct EvalContext {
+    using S = scalar_t<X>;
+
+    f64 t;
+    const X &x;
+
+    EvalContext(f64 t, const X &x) : t(t), x(x) {};
+    EvalContext(const EvalContext &) = delete;
+    EvalContext &operator=(const EvalContext &) = delete;
+
+    auto r() const { return x.template segment<3>(0); }
+    auto v() const { return x.template segment<3>(3); }
+
+    const S &r_mag() {
+        if (!r_mag_) {
+            r_mag_ = r().norm();
+        }
+        return *r_mag_;
+    }
+
+    // 1/|r|^3
+    const S &inv_r3() {
+        if (!inv_r3_) {
+            const S &rm = r_mag();
+            inv_r3_ = S(1.) / (rm * rm * rm);
+        }
+        return *inv_r3_;
+    }
+
+    // Inertial to body DCM from the quaternion at x[6..9] (states that carry
+    // attitude after position and velocity)
+    const mat3t<S> &body_dcm() {
+        static_assert(
+            X::SizeAtCompileTime == eig::Dynamic || X::SizeAtCompileTime >= 10,
+            "body_dcm needs a state with a quaternion at x[6..9]"
+        );
+        if (!body_dcm_) {
+            vec4t<S> q = x.template segment<4>(6);
+            body_dcm_ = ep_to_dcm(q);
+        }
+        return *body_dcm_;
+    }
+
+    // Inertial to Earth fixed, Earth rotating uniformly about z from gmst0
+    // at t = 0
+    const mat3 &ecef_rotation(f64 gmst0 = 0.) {
+        if (!ecef_) {
+            ecef_ = detail::rot3(gmst0 + omega_earth * t);
+        }
+        return *ecef_;
+    }
+
+    // GCRF to ITRF from a shared FrameCache
+    const mat3 &ecef_rotation(const FrameCache &frames) {
+        if (!ecef_) {
+            ecef_ = frames.eci_to_ecef(t);
+        }
+        return *ecef_;
+    }
+
+    // Geocentric Sun position, km
+    const vec3 &sun(const SunMoonEphemeris &eph) {
+        if (!sun_) {
+            sun_ = eph.sun_position(t);
+        }
+        return *sun_;
+    }
+
+  private:
+    std::optional<S> r_mag_;
+    std::optional<S> inv_r3_;
+    std::optional<mat3t<S>> body_dcm_;
+    std::optional<mat3> ecef_;
+    std::optional<vec3> sun_;
+};
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <cmath>
+
+#include "constants.h"
+#include "ephemeris.h"
+#include "typedefs.h"
+
+// -----------------------------------------------------------------------------
+// Time Scales
+// -----------------------------------------------------------------------------
+// Epochs are Julian dates. UTC is the input scale; TT drives precession and
+// nutation, UT1 drives Earth rotation. The Earth orientation parameters are
+// held constant (no leap second inside a propagation span).
+
+constexpr f64 arcsec2rad = deg2rad / 3600.;
+constexpr f64 tt_minus_tai = 32.184; // s
+
+struct EarthOrientation {
+    f64 dat = 37.; // TAI - UTC, s
+    f64 dut1 = 0.; // UT1 - UTC, s
+    f64 xp = 0.;   // polar motion, rad
+    f64 yp = 0.;   // polar motion, rad
+};
+
+inline f64 jd_tt(f64 jd_utc, const EarthOrientation &eop) {
+    return jd_utc + (eop.dat + tt_minus_tai) / sec_per_day;
+}
+
+inline f64 jd_ut1(f64 jd_utc, const EarthOrientation &eop) {
+    return jd_utc + eop.dut1 / sec_per_day;
+}
+
+// -----------------------------------------------------------------------------
+// Earth Rotation, Precession and Nutation (IAU-76/FK5, Vallado 3.7)
+// -----------------------------------------------------------------------------
+// GCRF (J2000) -> ITRF as W R3(GAST) N P, with frame rotations rot1/2/3
+// (positive angle rotates the frame, not the vector).
+
+namespace detail {
+inline mat3 rot1(f64 a) {
+    f64 c = std::cos(a);
+    f64 s = std::sin(a);
+    mat3 R;
+    R << 1., 0., 0., 0., c, s, 0., -s, c;
+    return R;
+}
+
+inline mat3 rot2(f64 a) {
+    f64 c = std::cos(a);
+    f64 s = std::sin(a);
+    mat3 R;
+    R << c, 0., -s, 0., 1., 0., s, 0., c;
+    return R;
+}
+
+inline mat3 rot3(f64 a) {
+    f64 c = std::cos(a);
+    f64 s = std::sin(a);
+    mat3 R;
+    R << c, s, 0., -s, c, 0., 0., 0., 1.;
+    return R;
+}
+
+// Largest terms of the IAU 1980 nutation series (Meeus Table 22.A):
+// multipliers of D, M, M', F, Omega, then dpsi and deps in 0.0001" as
+// constant + rate per Julian century
+struct NutationTerm {
+    i8 d, m, mp, f, om;
+    f64 psi0, psi1, eps0, eps1;
+};
+
+inline constexpr NutationTerm nutation_terms[] = {
+    {0, 0, 0, 0, 1, -171996., -174.2, 92025., 8.9},
+    {-2, 0, 0, 2, 2, -13187., -1.6, 5736., -3.1},
+    {0, 0, 0, 2, 2, -2274., -0.2, 977., -0.5},
+    {0, 0, 0, 0, 2, 2062., 0.2, -895., 0.5},
+    {0, 1, 0, 0, 0, 1426., -3.4, 54., -0.1},
+    {0, 0, 1, 0, 0, 712., 0.1, -7., 0.},
+    {-2, 1, 0, 2, 2, -517., 1.2, 224., -0.6},
+    {0, 0, 0, 2, 1, -386., -0.4, 200., 0.},
+    {0, 0, 1, 2, 2, -301., 0., 129., -0.1},
+    {-2, -1, 0, 2, 2, 217., -0.5, -95., 0.3},
+    {-2, 0, 1, 0, 0, -158., 0., 0., 0.},
+    {-2, 0, 0, 2, 1, 129., 0.1, -70., 0.},
+    {0, 0, -1, 2, 2, 123., 0., -53., 0.},
+    {2, 0, 0, 0, 0, 63., 0., 0., 0.},
+    {0, 0, 1, 0, 1, 63., 0.1, -33., 0.},
+    {2, 0, -1, 2, 2, -59., 0., 26., 0.},
+    {0, 0, -1, 0, 1, -58., -0.1, 32., 0.},
+    {0, 0, 1, 2, 1, -51., 0., 27., 0.},
+};
+} // namespace detail
+
+// Greenwich mean sidereal time (IAU-82), rad
+inline f64 gmst(f64 jd_ut1) {
+    f64 d = jd_ut1 - jd_j2000;
+    f64 T = d / 36525.;
+    // The 876600 h T term of the series is a whole number of days
+    f64 sec = 67310.54841 + 8640184.812866 * T + 0.093104 * T * T
+              - 6.2e-6 * T * T * T + (d - std::floor(d)) * sec_per_day;
+    f64 theta = std::fmod(sec, sec_per_day) * (twopi / sec_per_day);
+    return theta < 0. ? theta + twopi : theta;
+}
+
+// GCRF (mean equator and equinox of J2000) -> mean of date
+inline mat3 precession(f64 jd_tt) {
+    f64 T = (jd_tt - jd_j2000) / 36525.;
+    f64 T2 = T * T;
+    f64 T3 = T2 * T;
+    f64 zeta = (2306.2181 * T + 0.30188 * T2 + 0.017998 * T3) * arcsec2rad;
+    f64 theta = (2004.3109 * T - 0.42665 * T2 - 0.041833 * T3) * arcsec2rad;
+    f64 z = (2306.2181 * T + 1.09468 * T2 + 0.018203 * T3) * arcsec2rad;
+    return detail::rot3(-z) * detail::rot2(theta) * detail::rot3(-zeta);
+}
+
+struct Nutation {
+    f64 dpsi;     // in longitude, rad
+    f64 deps;     // in obliquity, rad
+    f64 eps_mean; // mean obliquity, rad
+    f64 omega;    // longitude of the Moon's ascending node, rad
+
+    // Mean of date -> true of date
+    mat3 matrix() const {
+        return detail::rot1(-(eps_mean + deps)) * detail::rot3(-dpsi)
+               * detail::rot1(eps_mean);
+    }
+
+    // GAST - GMST, rad
+    f64 equation_of_equinoxes() const {
+        return dpsi * std::cos(eps_mean + deps)
+               + (0.00264 * std::sin(omega) + 0.000063 * std::sin(2. * omega))
+                     * arcsec2rad;
+    }
+};
+
+// Truncated to the 18 largest terms, ~0.01" from the full series
+inline Nutation nutation(f64 jd_tt) {
+    f64 T = (jd_tt - jd_j2000) / 36525.;
+    f64 T2 = T * T;
+    f64 T3 = T2 * T;
+    f64 D = (297.85036 + 445267.111480 * T - 0.0019142 * T2 + T3 / 189474.)
+            * deg2rad;
+    f64 M = (357.52772 + 35999.050340 * T - 0.0001603 * T2 - T3 / 300000.)
+            * deg2rad;
+    f64 Mp = (134.96298 + 477198.867398 * T + 0.0086972 * T2 + T3 / 56250.)
+             * deg2rad;
+    f64 F = (93.27191 + 483202.017538 * T - 0.0036825 * T2 + T3 / 327270.)
+            * deg2rad;
+    f64 Om = (125.04452 - 1934.136261 * T + 0.0020708 * T2 + T3 / 450000.)
+             * deg2rad;
+
+    f64 dpsi = 0.;
+    f64 deps = 0.;
+    for (const detail::NutationTerm &k : detail::nutation_terms) {
+        f64 arg = k.d * D + k.m * M + k.mp * Mp + k.f * F + k.om * Om;
+        dpsi += (k.psi0 + k.psi1 * T) * std::sin(arg);
+        deps += (k.eps0 + k.eps1 * T) * std::cos(arg);
+    }
+
+    f64 eps_mean = 84381.448 - 46.8150 * T - 0.00059 * T2 + 0.001813 * T3;
+    return {
+        dpsi * 1e-4 * arcsec2rad,
+        deps * 1e-4 * arcsec2rad,
+        eps_mean * arcsec2rad,
+        Om,
+    };
+}
+
+// PEF -> ITRF
+inline mat3 polar_motion(const EarthOrientation &eop) {
+    return detail::rot2(-eop.xp) * detail::rot1(-eop.yp);
+}
+
+// GCRF -> ITRF, every term evaluated at jd_utc
+inline mat3 eci_to_ecef(f64 jd_utc, const EarthOrientation &eop = {}) {
+    f64 tt = jd_tt(jd_utc, eop);
+    Nutation nut = nutation(tt);
+    f64 gast = gmst(jd_ut1(jd_utc, eop)) + nut.equation_of_equinoxes();
+    return polar_motion(eop) * detail::rot3(gast) * nut.matrix()
+           * precession(tt);
+}
+
+// -----------------------------------------------------------------------------
+// Frame Cache
+// -----------------------------------------------------------------------------
+// Precession-nutation N P and the equation of the equinoxes change over days
+// (the fastest retained nutation term has a 9 day period), so they are
+// sampled on a coarse grid over [t0, tf] (seconds past jd0, UTC) and
+// interpolated with the ephemeris tables' cubic Lagrange scheme; the default
+// half-day grid keeps the interpolation error near 1e-10 rad. A rotation at
+// time t then costs one interpolation, one GMST polynomial with one sin/cos
+// and a 3x3 product. Immutable after construction, so one instance can be
+// shared by every satellite and thread, like SunMoonEphemeris.
+
+struct FrameCache {
+    f64 jd0; // Julian date (UTC) at t = 0
+    EarthOrientation eop;
+    mat3 W;                     // polar motion
+    UniformTable<vec10> pn_eqe; // N P (row major), equation of the equinoxes
+
+    FrameCache(
+        f64 jd0,
+        f64 t0,
+        f64 tf,
+        const EarthOrientation &eop = {},
+        f64 h = sec_per_day / 2.
+    )
+        : jd0(jd0), eop(eop), W(polar_motion(eop)),
+          pn_eqe(
+              [jd0, eop](f64 t) {
+                  f64 tt = jd_tt(jd0 + t / sec_per_day, eop);
+                  Nutation nut = nutation(tt);
+                  mat3 PN = nut.matrix() * precession(tt);
+                  vec10 y;
+                  y << PN.row(0).transpose(), PN.row(1).transpose(),
+                      PN.row(2).transpose(), nut.equation_of_equinoxes();
+                  return y;
+              },
+              t0,
+              tf,
+              h
+          ) {};
+
+    // GCRF -> ITRF at t seconds past jd0
+    mat3 eci_to_ecef(f64 t) const {
+        vec10 y = pn_eqe(t);
+        mat3 PN;
+        PN << y.head<3>().transpose(), y.segment<3>(3).transpose(),
+            y.segment<3>(6).transpose();
+        f64 gast = gmst(jd_ut1(jd0 + t / sec_per_day, eop)) + y(9);
+        return W * detail::rot3(gast) * PN;
+    }
+
+    mat3 ecef_to_eci(f64 t) const { return eci_to_ecef(t).transpose(); }
+};
@@ -1,12 +1,20 @@
+#pragma once
 
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "CelestialBody.h"
+#include "dual.h"
+#include "ephemeris.h"
+#include "eval_context.h"
 #include "typedefs.h"
+#include "units.h"
 
 template <typename State, typename ForcePolicy> struct EOM {
     ForcePolicy forces;
@@ -14,24 +22,56 @@ template <typename State, typename ForcePolicy> struct EOM {
     // Constructor
     explicit EOM(const ForcePolicy &fp) : forces(fp) {};
 
-    State operator()(f64 t, State &x) const {
+    State operator()(f64 t, const State &x) const {
         State dxdt;
-        dxdt << x.template segment<3>(0), forces.acceleration(x);
+        dxdt << x.template segment<3>(3), forces.acceleration(t, x);
 
         return dxdt;
     }
 };
 
+// Policies provide acceleration(ctx) with a shared EvalContext, or
+// acceleration(t, x) / acceleration(x) when they need nothing derived
+template <typename P, typename X>
+auto policy_acceleration(const P &p, EvalContext<X> &ctx) {
+    if constexpr (requires { p.acceleration(ctx); }) {
+        return p.acceleration(ctx);
+    } else if constexpr (requires { p.acceleration(ctx.t, ctx.x); }) {
+        return p.acceleration(ctx.t, ctx.x);
+    } else {
+        return p.acceleration(ctx.x);
+    }
+}
+
+template <typename P, typename State>
+auto policy_acceleration(const P &p, f64 t, const State &x) {
+    EvalContext<State> ctx(t, x);
+    return policy_acceleration(p, ctx);
+}
+
+// Sums in the state's scalar type; policies evaluated in another precision
+// are cast on accumulation. Policies take the state type X as a member
+// template parameter, so the same composition also runs on dual numbers
+// (acceleration_jacobian below); State is the nominal state type. All
+// policies of one call share an EvalContext. There is deliberately no
+// acceleration(x): time-dependent policies need the epoch of every call.
 template <typename State, typename... Policies> struct ForcePolicy3D {
     std::tuple<Policies...> policies;
 
     explicit ForcePolicy3D(const Policies &...ps) : policies(ps...) {};
 
-    vec3 acceleration(const State &x) const {
-        vec3 a_total = vec3::Zero();
+    template <typename X>
+    vec3t<scalar_t<X>> acceleration(f64 t, const X &x) const {
+        using S = scalar_t<X>;
+        vec3t<S> a_total = vec3t<S>::Zero();
+        EvalContext<X> ctx(t, x);
 
         std::apply(
-            [&](auto const &...p) { ((a_total += p.acceleration(x)), ...); },
+            [&](auto const &...p) {
+                ((a_total
+                  += policy_acceleration(p, ctx).template cast<S>()),
+                 ...);
+            },
             policies
         );
 
@@ -39,57 +79,121 @@ template <typename State, typename... Policies> struct ForcePolicy3D {
     }
 };
 
+// Acceleration and its Jacobian d(a)/d(r, v) from one dual-number pass
+template <typename ForcePolicy>
+std::pair<vec3, eig::Matrix<f64, 3, 6>>
+acceleration_jacobian(const ForcePolicy &forces, f64 t, const vec6 &x) {
+    vec3t<Dual<6>> a = forces.acceleration(t, dual_variables(x));
+    return {dual_values(a), dual_jacobian(a)};
+}
+
+// Jacobian of the first order EOM [v, a] with respect to [r, v], the
+// variational matrix for STM propagation
+template <typename ForcePolicy>
+mat6 state_jacobian(const ForcePolicy &forces, f64 t, const vec6 &x) {
+    mat6 A = mat6::Zero();
+    A.block<3, 3>(0, 3) = mat3::Identity();
+    A.block<3, 6>(3, 0) = acceleration_jacobian(forces, t, x).second;
+    return A;
+}
+
+// State and state transition matrix [x, vec(Phi)] (Phi column major),
+// dPhi/dt = A(t, x) Phi with A from state_jacobian
+template <typename ForcePolicy> struct STMEOM {
+    ForcePolicy forces;
+
+    explicit STMEOM(const ForcePolicy &fp) : forces(fp) {};
+
+    vec42 operator()(f64 t, const vec42 &y) const {
+        vec6 x = y.head<6>();
+        eig::Map<const mat6> Phi(y.data() + 6);
+        auto [a, J] = acceleration_jacobian(forces, t, x);
+
+        vec42 dydt;
+        dydt.head<3>() = x.segment<3>(3);
+        dydt.segment<3>(3) = a;
+        eig::Map<mat6> dPhi(dydt.data() + 6);
+        dPhi.topRows<3>() = Phi.bottomRows<3>();
+        dPhi.bottomRows<3>() = J * Phi;
+        return dydt;
+    }
+};
+
+inline vec42 stm_initial(const vec6 &x) {
+    vec42 y;
+    y << x, mat6::Identity().reshaped();
+    return y;
+}
+
 template <typename State> struct NewtonianGravityPolicy {
     f64 mu;
 
     explicit NewtonianGravityPolicy(f64 mu) : mu(mu) {};
+    explicit NewtonianGravityPolicy(GravParam mu) : mu(mu.value) {};
 
-    vec3 acceleration(const State &x) {
-        vec3 r = x.template segment<3>(0);
-        f64 r_mag = r.norm();
-
-        vec3 a = -mu / (r_mag * r_mag * r_mag) * r;
+    template <typename X>
+    vec3t<scalar_t<X>> acceleration(EvalContext<X> &ctx) const {
+        using S = scalar_t<X>;
+        vec3t<S> a = -S(mu) * ctx.inv_r3() * ctx.r();
         return a;
     }
 };
 
+// With central = false only the zonal terms are returned, so the policy can
+// sit next to NewtonianGravityPolicy as a perturbation (e.g. in f32)
 template <typename State> struct ZonalGravityPolicy {
     f64 mu;
     std::vector<f64> J;
     f64 R_cb;
     int max_degree;
+    bool central;
 
     explicit ZonalGravityPolicy(
         f64 mu,
         std::vector<f64> J,
         f64 R_cb,
-        int max_degree
+        int max_degree,
+        bool central = true
     )
-        : mu(mu), J(J), R_cb(R_cb), max_degree(max_degree) {}
+        : mu(mu), J(J), R_cb(R_cb), max_degree(max_degree), central(central) {}
+    explicit ZonalGravityPolicy(
+        GravParam mu,
+        std::vector<f64> J,
+        Kilometers R_cb,
+        int max_degree,
+        bool central = true
+    )
+        : mu(mu.value), J(J), R_cb(R_cb.value), max_degree(max_degree),
+          central(central) {}
+
+    template <typename X>
+    vec3t<scalar_t<X>> acceleration(EvalContext<X> &ctx) const {
+        using S = scalar_t<X>;
+        vec3t<S> r = ctx.r();
 
-    vec3 acceleration(const State &x) {
         // Newontian Gravity
-        NewtonianGravityPolicy<vec6> newton(mu);
-        vec3 a = newton.acceleration(x);
+        vec3t<S> a = vec3t<S>::Zero();
+        if (central) {
+            a = -S(mu) * ctx.inv_r3() * r;
+        }
 
         // Add Zonal Gravity Perturbations (only J2 for now)
-        vec3 r = x.template segment<3>(0);
-        f64 J2 = J[1];
-        f64 r_mag = r.norm();
-        f64 r_mag2 = r.squaredNorm();
-        f64 Ror = R_cb / r_mag;
-        f64 Ror2 = Ror * Ror;
-        f64 muor2 = mu / r_mag2;
-        f64 r0or = r(0) / r_mag;
-        f64 r1or = r(1) / r_mag;
-        f64 r2or = r(2) / r_mag;
-        f64 r2or2 = r2or * r2or;
-
-        f64 coef = -3. / 2. * J2 * muor2 * Ror2;
-        vec3 vec_comp = vec3(
-            (1. - 5. * r2or2) * r0or, //
-            (1. - .5 * r2or2) * r1or, //
-            (3. - 5. * r2or2) * r2or  //
+        S J2 = S(J[1]);
+        S r_mag = ctx.r_mag();
+        S r_mag2 = r.squaredNorm();
+        S Ror = S(R_cb) / r_mag;
+        S Ror2 = Ror * Ror;
+        S muor2 = S(mu) / r_mag2;
+        S r0or = r(0) / r_mag;
+        S r1or = r(1) / r_mag;
+        S r2or = r(2) / r_mag;
+        S r2or2 = r2or * r2or;
+
+        S coef = S(-3. / 2.) * J2 * muor2 * Ror2;
+        vec3t<S> vec_comp = vec3t<S>(
+            (1 - 5 * r2or2) * r0or, //
+            (1 - 5 * r2or2) * r1or, //
+            (3 - 5 * r2or2) * r2or  //
         );
 
         a += coef * vec_comp;
@@ -97,15 +201,292 @@ template <typename State> struct ZonalGravityPolicy {
     }
 };
 
+// Mixed precision: evaluates a perturbation built on the f32 state vec6f while
+// the integrator state and the force sum stay f64. The relative error of the
+// result is ~1e-7, which is harmless for small perturbations (J2, etc.) but
+// not for the central term, so keep NewtonianGravityPolicy in f64. Policies
+// that difference nearly equal vectors (third body, drag, SRP) stay f64 only.
+// Non floating point states (dual numbers) pass through unchanged.
+//
+// Positions are cast to f32 as absolute ECI coordinates, not stored relative
+// to a per-object reference: rounding moves a LEO position by up to ~0.4 m,
+// which costs ~3.5e-12 km/s^2 of the ~2e-11 km/s^2 worst case J2 error.
+template <typename State, typename Policy32> struct Float32Policy {
+    Policy32 policy;
+
+    explicit Float32Policy(const Policy32 &p) : policy(p) {};
+
+    template <typename X>
+    vec3t<scalar_t<X>> acceleration(f64 t, const X &x) const {
+        if constexpr (std::is_floating_point_v<scalar_t<X>>) {
+            vec6f xf = x.template head<6>().template cast<f32>();
+            return policy_acceleration(policy, t, xf)
+                .template cast<scalar_t<X>>();
+        } else {
+            return policy_acceleration(policy, t, x);
+        }
+    }
+};
+
+// Point mass third body (Sun/Moon) from a shared ephemeris cache
+template <typename State> struct ThirdBodyGravityPolicy {
+    f64 mu;
+    ThirdBody body;
+    std::shared_ptr<const SunMoonEphemeris> eph;
+
+    explicit ThirdBodyGravityPolicy(
+        ThirdBody body,
+        std::shared_ptr<const SunMoonEphemeris> eph
+    )
+        : mu(body == ThirdBody::SUN ? mu_sun : mu_moon), body(body),
+          eph(std::move(eph)) {}
+
+    template <typename X>
+    vec3t<scalar_t<X>> acceleration(EvalContext<X> &ctx) const {
+        using S = scalar_t<X>;
+        vec3t<S> r = ctx.r();
+        vec3 r3 = body == ThirdBody::SUN ? ctx.sun(*eph)
+                                         : eph->moon_position(ctx.t);
+        vec3t<S> d = r3.template cast<S>() - r;
+        S d_mag = d.norm();
+        f64 r3_mag = r3.norm();
+        vec3 indirect = mu / (r3_mag * r3_mag * r3_mag) * r3;
+
+        // Direct term minus indirect (central body) term
+        vec3t<S> a = S(mu) / (d_mag * d_mag * d_mag) * d
+                     - indirect.template cast<S>();
+        return a;
+    }
+};
+
+// -----------------------------------------------------------------------------
+// Spherical Harmonic Gravity
+// -----------------------------------------------------------------------------
+// Fully normalized field from EGMCoefficients, evaluated in the Earth fixed
+// frame with the Cunningham V/W recursion (Montenbruck & Gill 3.2.4) carried
+// over to normalized terms, so it is free of polar singularities and stable
+// to high degree. The ECEF rotation comes from a shared FrameCache, or from a
+// uniformly rotating Earth without one, through the EvalContext.
+//
+// Degree truncation: degree n contributes at most
+//   |a_n| <= mu / r^2 (R/r)^n beta_n,  beta_n = sigma_n (2n + 1) sqrt(n + 1)
+// with sigma_n the rms of the degree n coefficients (addition theorem and
+// Cauchy-Schwarz). With tol > 0 each call keeps the lowest degree N whose
+// dropped tail sum_{n > N} of these bounds is within tol (km/s^2), so the
+// cost falls off by itself with altitude: a full 180x180 field at LEO is a
+// handful of degrees at GEO. tol = 0 always evaluates the full field.
+
+// Recursion and acceleration coefficients, shared by every copy of a policy
+struct SphericalHarmonicTables {
+    // Field degree and order
+    int N, M;
+    // Normalized coefficients, indexed tri(n, m)
+    std::vector<f64> C, S;
+    // Recursion: V_nm from V_n-1,m and V_n-2,m (a, b), V_mm from
+    // V_m-1,m-1 (c)
+    std::vector<f64> a, b, c;
+    // Acceleration factors of the V_n+1,m+1, V_n+1,m-1 and V_n+1,m terms
+    std::vector<f64> fp, fm, fz;
+    // Per-degree acceleration bound
+    std::vector<f64> beta;
+
+    static int tri(int n, int m) { return n * (n + 1) / 2 + m; }
+
+    explicit SphericalHarmonicTables(const EGMCoefficients &egm)
+        : N(egm.max_degree), M(std::min(egm.max_order, egm.max_degree)) {
+        const int Nv = N + 1; // V/W run one degree past the field
+        const int n_tri = tri(Nv, Nv) + 1;
+        C.assign(n_tri, 0.);
+        S.assign(n_tri, 0.);
+        a.assign(n_tri, 0.);
+        b.assign(n_tri, 0.);
+        fp.assign(n_tri, 0.);
+        fm.assign(n_tri, 0.);
+        fz.assign(n_tri, 0.);
+        c.assign(Nv + 1, 0.);
+        beta.assign(N + 1, 0.);
+
+        for (int n = 0; n <= Nv; n++) {
+            for (int m = 0; m <= n; m++) {
+                f64 dn = n;
+                f64 dm = m;
+                int k = tri(n, m);
+                if (n <= N && m <= M) {
+                    C[k] = egm.getC(n, m);
+                    S[k] = egm.getS(n, m);
+                }
+                if (n > m) {
+                    a[k] = std::sqrt(
+                        (2. * dn + 1.) * (2. * dn - 1.)
+                        / ((dn - dm) * (dn + dm))
+                    );
+                }
+                if (n > m + 1) {
+                    b[k] = std::sqrt(
+                        (2. * dn + 1.) * (dn + dm - 1.) * (dn - dm - 1.)
+                        / ((2. * dn - 3.) * (dn - dm) * (dn + dm))
+                    );
+                }
+                f64 q = (2. * dn + 1.) / (2. * dn + 3.);
+                fp[k] = std::sqrt(
+                    (m == 0 ? 0.5 : 1.) * q * (dn + dm + 1.) * (dn + dm + 2.)
+                );
+                if (m > 0) {
+                    fm[k] = std::sqrt(
+                        (m == 1 ? 2. : 1.) * q * (dn - dm + 1.) * (dn - dm + 2.)
+                    );
+                }
+                fz[k] = std::sqrt(q * (dn + dm + 1.) * (dn - dm + 1.));
+            }
+        }
+        for (int m = 1; m <= Nv; m++) {
+            c[m] = std::sqrt((m == 1 ? 2. : 1.) * (2. * m + 1.) / (2. * m));
+        }
+        for (int n = 2; n <= N; n++) {
+            f64 ss = 0.;
+            for (int m = 0; m <= std::min(n, M); m++) {
+                int k = tri(n, m);
+                ss += C[k] * C[k] + S[k] * S[k];
+            }
+            f64 sigma = std::sqrt(ss / (2. * n + 1.));
+            beta[n] = sigma * (2. * n + 1.) * std::sqrt(n + 1.);
+        }
+    }
+};
+
 template <typename State> struct SphericalHarmonicGravityPolicy {
     f64 mu;
     f64 R_cb;
-    EGMCoefficients &egm;
-    int max_degree, max_order;
+    std::shared_ptr<const SphericalHarmonicTables> tables;
+    std::shared_ptr<const FrameCache> frames; // null: uniform rotation
+    f64 tol;      // truncation budget, km/s^2 (0 = full field)
+    bool central; // include the point mass term
 
     explicit SphericalHarmonicGravityPolicy(
-        
+        f64 mu,
+        f64 R_cb,
+        const EGMCoefficients &egm,
+        std::shared_ptr<const FrameCache> frames = nullptr,
+        f64 tol = 0.,
+        bool central = true
+    )
+        : mu(mu), R_cb(R_cb),
+          tables(std::make_shared<const SphericalHarmonicTables>(egm)),
+          frames(std::move(frames)), tol(tol), central(central) {}
+
+    // Tables built once and shared with other policies (ModelCache)
+    SphericalHarmonicGravityPolicy(
+        f64 mu,
+        f64 R_cb,
+        std::shared_ptr<const SphericalHarmonicTables> tables,
+        std::shared_ptr<const FrameCache> frames = nullptr,
+        f64 tol = 0.,
+        bool central = true
     )
-        : mu(mu), R_cb(R_cb), max_degree(egm.max_degree),
-          max_order(egm.max_order), egm(egm) {}
+        : mu(mu), R_cb(R_cb), tables(std::move(tables)),
+          frames(std::move(frames)), tol(tol), central(central) {}
+
+    // Degree evaluated at radius r (below 2: central term only)
+    int degree(f64 r) const {
+        const std::vector<f64> &beta = tables->beta;
+        int n = tables->N;
+        if (tol <= 0.) {
+            return n;
+        }
+        f64 q = R_cb / r;
+        f64 scale = mu / (r * r);
+        f64 qn = std::pow(q, n);
+        f64 tail = 0.;
+        for (; n >= 2; n--) {
+            tail += scale * beta[n] * qn;
+            if (tail > tol) {
+                break;
+            }
+            qn /= q;
+        }
+        return n;
+    }
+
+    template <typename X>
+    vec3t<scalar_t<X>> acceleration(EvalContext<X> &ctx) const {
+        using S = scalar_t<X>;
+        const SphericalHarmonicTables &T = *tables;
+        using Tab = SphericalHarmonicTables;
+
+        vec3t<S> a = vec3t<S>::Zero();
+        if (central) {
+            a = -S(mu) * ctx.inv_r3() * ctx.r();
+        }
+        const int N = degree(static_cast<f64>(ctx.r_mag()));
+        if (N < 2) {
+            return a;
+        }
+        const int M = std::min(N, T.M);
+
+        const mat3 &E
+            = frames ? ctx.ecef_rotation(*frames) : ctx.ecef_rotation();
+        vec3t<S> r = E.template cast<S>() * ctx.r();
+
+        // V_nm, W_nm for n <= N + 1, m <= M + 1
+        const int Nv = N + 1;
+        const int Mv = M + 1;
+        thread_local std::vector<S> V, W;
+        V.resize(Tab::tri(Nv, Nv) + 1);
+        W.resize(V.size());
+
+        const S k = S(R_cb) / (ctx.r_mag() * ctx.r_mag());
+        const S kR = k * S(R_cb);
+        const S zk = r(2) * k;
+        for (int m = 0; m <= Mv; m++) {
+            int mm = Tab::tri(m, m);
+            if (m == 0) {
+                V[0] = S(R_cb) / ctx.r_mag();
+                W[0] = S(0.);
+            } else {
+                int p = Tab::tri(m - 1, m - 1);
+                S cm = S(T.c[m]) * k;
+                V[mm] = cm * (r(0) * V[p] - r(1) * W[p]);
+                W[mm] = cm * (r(0) * W[p] + r(1) * V[p]);
+            }
+            for (int n = m + 1; n <= Nv; n++) {
+                int i = Tab::tri(n, m);
+                int i1 = Tab::tri(n - 1, m);
+                V[i] = S(T.a[i]) * zk * V[i1];
+                W[i] = S(T.a[i]) * zk * W[i1];
+                if (n > m + 1) {
+                    int i2 = Tab::tri(n - 2, m);
+                    V[i] -= S(T.b[i]) * kR * V[i2];
+                    W[i] -= S(T.b[i]) * kR * W[i2];
+                }
+            }
+        }
+
+        S ax = S(0.), ay = S(0.), az = S(0.);
+        for (int n = 2; n <= N; n++) {
+            for (int m = 0; m <= std::min(n, M); m++) {
+                int i = Tab::tri(n, m);
+                const f64 Cnm = T.C[i];
+                const f64 Snm = T.S[i];
+                int up = Tab::tri(n + 1, m + 1);
+                int mid = Tab::tri(n + 1, m);
+                if (m == 0) {
+                    ax -= (Cnm * T.fp[i]) * V[up];
+                    ay -= (Cnm * T.fp[i]) * W[up];
+                } else {
+                    int lo = Tab::tri(n + 1, m - 1);
+                    ax += 0.5
+                          * (T.fp[i] * (-Cnm * V[up] - Snm * W[up])
+                             + T.fm[i] * (Cnm * V[lo] + Snm * W[lo]));
+                    ay += 0.5
+                          * (T.fp[i] * (-Cnm * W[up] + Snm * V[up])
+                             + T.fm[i] * (-Cnm * W[lo] + Snm * V[lo]));
+                }
+                az += T.fz[i] * (-Cnm * V[mid] - Snm * W[mid]);
+            }
+        }
+
+        vec3t<S> a_ecef = S(mu / (R_cb * R_cb)) * vec3t<S>(ax, ay, az);
+        a += E.transpose().template cast<S>() * a_ecef;
+        return a;
+    }
 };
@@ -6,6 +6,8 @@
 
 #include "AdaptiveIntegrators.h"
 #include "FixedIntegrators.h"
+#include "trajectory.h"
+#include <cmath>
 #include <vector>
 
 const int N_DEFAULT = 1000;
@@ -31,16 +33,23 @@ struct FixedStepIntegrator {
         dt0_ = t_span / static_cast<f64>(N_steps);
     };
 
-    // Integrate from t0 to tf
+    // Integrate from t0 to tf. times/states are std::vector or any sequence
+    // with clear/push_back (e.g. ChunkedSeq); storage is pre-sized from dt0_.
+    template <typename TimeSeq, typename StateSeq>
     void integrate(
         double t0,
         double tf,
         const State &x0,
-        std::vector<double> &times,
-        std::vector<State> &states
+        TimeSeq &times,
+        StateSeq &states
     ) const {
         times.clear();
         states.clear();
+        // No steps (and a single sample) when tf <= t0
+        f64 n_steps = std::ceil((tf - t0) / dt0_);
+        size_t N = n_steps > 0. ? static_cast<size_t>(n_steps) + 1 : 1;
+        reserve_samples(times, N);
+        reserve_samples(states, N);
 
         // Initialize states and storage
         double t = t0;
@@ -58,6 +67,14 @@ struct FixedStepIntegrator {
             states.push_back(x_new);
         }
     }
+    void integrate(
+        double t0,
+        double tf,
+        const State &x0,
+        Trajectory<State> &traj
+    ) const {
+        integrate(t0, tf, x0, traj.times, traj.states);
+    }
 };
 
 // Adaptive Step Size
@@ -75,13 +92,15 @@ struct AdaptiveStepIntegrator {
     AdaptiveStepIntegrator(F f, f64 dt0 = DT_DEFAULT, f64 tol = TOL_DEFAULT)
         : f_(std::move(f)), dt_(dt0), tol_(tol) {};
 
-    // Integrate from t0 to tf
+    // Integrate from t0 to tf. The step count is not known up front, so
+    // storage grows as it goes (in chunks for ChunkedSeq/Trajectory).
+    template <typename TimeSeq, typename StateSeq>
     void integrate(
         double t0,
         double tf,
         const State &x0,
-        std::vector<double> &times,
-        std::vector<State> &states
+        TimeSeq &times,
+        StateSeq &states
     ) {
         times.clear();
         states.clear();
@@ -122,4 +141,12 @@ struct AdaptiveStepIntegrator {
             states.push_back(x);
         }
     }
+    void integrate(
+        double t0,
+        double tf,
+        const State &x0,
+        Trajectory<State> &traj
+    ) {
+        integrate(t0, tf, x0, traj.times, traj.states);
+    }
 };
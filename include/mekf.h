@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cmath>
+
+#include "attitude.h"
+#include "typedefs.h"
+
+// -----------------------------------------------------------------------------
+// Multiplicative Extended Kalman Filter
+// -----------------------------------------------------------------------------
+// Attitude and gyro bias estimation (Markley & Crassidis, ch. 6). The global
+// attitude is the quaternion q (scalar last, body from inertial,
+// A(q) = ep_to_dcm(q)) propagated with ep_kde; the filter estimates the
+// 6-state error [dtheta, db] with dtheta a small body-frame rotation.
+//
+// Everything is fixed size and lives in the object: predict and update do
+// not allocate and run a fixed number of operations, so their latency is
+// bounded. Vector measurements (star tracker line of sight, normalized
+// magnetometer field) are processed one component at a time as scalar
+// updates; no matrix inverse is needed.
+
+struct MEKF {
+    vec4 q;      // attitude, body from inertial
+    vec3 bias;   // gyro bias, rad/s
+    mat6 P;      // error covariance [dtheta, db]
+    f64 sigma_v; // gyro angle random walk, rad/s^(1/2)
+    f64 sigma_u; // gyro bias random walk, rad/s^(3/2)
+
+    MEKF(
+        const vec4 &q0,
+        const vec3 &bias0,
+        const mat6 &P0,
+        f64 sigma_v,
+        f64 sigma_u
+    )
+        : q(q0.normalized()), bias(bias0), P(P0), sigma_v(sigma_v),
+          sigma_u(sigma_u) {};
+
+    // Propagate over dt with the measured body rate (held constant)
+    void predict(const vec3 &omega_meas, f64 dt) {
+        const vec3 w = omega_meas - bias;
+
+        // RK4 on the quaternion kinematics
+        const vec4 k1 = ep_kde(q, w);
+        const vec4 q2 = q + 0.5 * dt * k1;
+        const vec4 k2 = ep_kde(q2, w);
+        const vec4 q3 = q + 0.5 * dt * k2;
+        const vec4 k3 = ep_kde(q3, w);
+        const vec4 q4 = q + dt * k3;
+        const vec4 k4 = ep_kde(q4, w);
+        q += dt / 6. * (k1 + 2. * k2 + 2. * k3 + k4);
+        q.normalize();
+
+        // Phi = I + F dt + F^2 dt^2 / 2 with F = [-[w x], -I; 0, 0]
+        const mat3 Wx = skew(w);
+        mat6 Phi = mat6::Identity();
+        Phi.block<3, 3>(0, 0) += -Wx * dt + 0.5 * dt * dt * Wx * Wx;
+        Phi.block<3, 3>(0, 3) = -mat3::Identity() * dt + 0.5 * dt * dt * Wx;
+
+        const f64 v2 = sigma_v * sigma_v;
+        const f64 u2 = sigma_u * sigma_u;
+        mat6 Q = mat6::Zero();
+        Q.block<3, 3>(0, 0).diagonal().setConstant(
+            v2 * dt + u2 * dt * dt * dt / 3.
+        );
+        Q.block<3, 3>(0, 3).diagonal().setConstant(-0.5 * u2 * dt * dt);
+        Q.block<3, 3>(3, 0).diagonal().setConstant(-0.5 * u2 * dt * dt);
+        Q.block<3, 3>(3, 3).diagonal().setConstant(u2 * dt);
+
+        P = Phi * P * Phi.transpose() + Q;
+    }
+
+    // Unit vector measurement b_meas = A(q) r_ref + noise (sigma per axis)
+    void update_vector(const vec3 &b_meas, const vec3 &r_ref, f64 sigma) {
+        const vec3 b_pred = ep_to_dcm(q) * r_ref;
+        const mat3 Bx = skew(b_pred);
+        const f64 R = sigma * sigma;
+
+        // Sequential scalar updates, one per measured component
+        vec6 dx = vec6::Zero();
+        for (int i = 0; i < 3; i++) {
+            eig::Matrix<f64, 1, 6> h;
+            h << Bx.row(i), 0., 0., 0.;
+            const vec6 Ph = P * h.transpose();
+            const vec6 K = Ph / (h.dot(Ph.transpose()) + R);
+            dx += K * (b_meas(i) - b_pred(i) - h.dot(dx.transpose()));
+            P.noalias() -= K * Ph.transpose();
+        }
+        P = 0.5 * (P + P.transpose());
+
+        reset(dx);
+    }
+
+    // Fold the error state into q and bias
+    void reset(const vec6 &dx) {
+        const vec3 dth = dx.head<3>();
+        const vec3 qv = q.head<3>();
+        vec4 dq;
+        dq << q(3) * dth + qv.cross(dth), -qv.dot(dth);
+        q += 0.5 * dq;
+        q.normalize();
+        bias += dx.tail<3>();
+    }
+
+    mat3 attitude() const { return ep_to_dcm(q); }
+};
@@ -0,0 +1,220 @@
+/* C ABI of liboadcs: propagators, gravity models and attitude conversions
+ * for callers outside C++ (Python ctypes/cffi, see oadcs.py).
+ *
+ * Every array argument is caller owned: a pointer to the first row and the
+ * row stride in bytes, so a numpy array passes as arr.ctypes.data and
+ * arr.strides[0] without a copy. The components of one row are contiguous
+ * doubles (numpy: arr.strides[-1] == 8); rows may be spaced arbitrarily, e.g.
+ * a column slice of a wider array. A stride of 0 repeats one row for every
+ * element where an input allows it. Pointers and strides must be 8-byte
+ * aligned.
+ *
+ * Functions return OADCS_OK or a negative status; oadcs_last_error() then
+ * describes the failure (per thread). No C++ exception crosses the ABI.
+ * Batch calls loop in C++ over all n elements, so a Python caller pays the
+ * call overhead once per batch, and ctypes drops the GIL for the call. */
+
+#ifndef OADCS_H
+#define OADCS_H
+
+#include <stddef.h>
+
+#if defined(_WIN32)
+#if defined(OADCS_BUILD)
+#define OADCS_API __declspec(dllexport)
+#else
+#define OADCS_API __declspec(dllimport)
+#endif
+#else
+#define OADCS_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped on any incompatible change to the functions below */
+#define OADCS_ABI_VERSION 1
+
+enum {
+    OADCS_OK = 0,
+    OADCS_EINVAL = -1, /* bad argument (null, misaligned, out of range) */
+    OADCS_ERROR = -2,  /* failure inside the library */
+};
+
+OADCS_API int oadcs_abi_version(void);
+OADCS_API const char *oadcs_last_error(void);
+
+/* ------------------------------------------------------------------------
+ * Gravity models
+ * ------------------------------------------------------------------------
+ * Spherical harmonic field to degree/order (fully normalized coefficients)
+ * with the central term, in km and s. Positions are inertial; the Earth
+ * fixed frame rotates uniformly from GMST 0 at t = 0. tol > 0 truncates the
+ * degree with altitude so the dropped terms stay below tol (km/s^2). Degree
+ * below 2 gives a point mass. A model is immutable once created and may be
+ * shared by threads. */
+
+typedef struct oadcs_gravity oadcs_gravity;
+
+/* From the tables compiled into the library (degree <= 20), no file access;
+ * year 1984, 1996 or 2008 as embedded at build time */
+OADCS_API oadcs_gravity *oadcs_gravity_create(
+    double mu,
+    double R,
+    int year,
+    int degree,
+    int order,
+    double tol
+);
+
+/* From a model file, as EGMCoefficients::load_egm */
+OADCS_API oadcs_gravity *oadcs_gravity_load(
+    const char *path,
+    double mu,
+    double R,
+    int year,
+    int degree,
+    int order,
+    double tol
+);
+
+OADCS_API void oadcs_gravity_destroy(oadcs_gravity *g);
+
+/* a[i] = acceleration at time t[i], position r[i]; rows of 3 (t: 1) */
+OADCS_API int oadcs_gravity_accel(
+    const oadcs_gravity *g,
+    size_t n,
+    const double *t,
+    ptrdiff_t t_stride,
+    const double *r,
+    ptrdiff_t r_stride,
+    double *a,
+    ptrdiff_t a_stride
+);
+
+/* ------------------------------------------------------------------------
+ * Propagation
+ * ------------------------------------------------------------------------
+ * States are rows of 6: [x, y, z, vx, vy, vz]. Fixed step RK4. */
+
+/* xf[i] = x0[i] propagated from t0 to tf in steps of dt (the last step is
+ * shortened to land on tf), n_threads workers (0 = all cores); n at most
+ * INT_MAX. dt must be finite, positive and large enough to advance t0 and
+ * tf. */
+OADCS_API int oadcs_propagate(
+    const oadcs_gravity *g,
+    size_t n,
+    const double *x0,
+    ptrdiff_t x0_stride,
+    double t0,
+    double tf,
+    double dt,
+    double *xf,
+    ptrdiff_t xf_stride,
+    int n_threads
+);
+
+/* out[k] = state at t0 + k dt for k = 0 .. n_steps (n_steps + 1 rows); dt
+ * as for oadcs_propagate */
+OADCS_API int oadcs_propagate_trajectory(
+    const oadcs_gravity *g,
+    const double *x0,
+    double t0,
+    double dt,
+    size_t n_steps,
+    double *out,
+    ptrdiff_t out_stride
+);
+
+/* Point mass + J2 only, all n states stepped together on the SIMD batch
+ * kernels: n_steps steps of dt; n at most INT_MAX */
+OADCS_API int oadcs_propagate_j2(
+    size_t n,
+    double mu,
+    double J2,
+    double R,
+    const double *x0,
+    ptrdiff_t x0_stride,
+    double dt,
+    size_t n_steps,
+    double *xf,
+    ptrdiff_t xf_stride
+);
+
+/* ------------------------------------------------------------------------
+ * Attitude
+ * ------------------------------------------------------------------------
+ * Euler parameters are rows of 4 with the scalar last; DCMs are rows of 9,
+ * row-major 3x3 (numpy shape (n, 3, 3)). Same conventions as attitude.h. */
+
+OADCS_API int oadcs_ep_to_dcm(
+    size_t n,
+    const double *q,
+    ptrdiff_t q_stride,
+    double *R,
+    ptrdiff_t R_stride
+);
+
+/* As attitude.h, whose dcm_to_ep takes the opposite sign convention to
+ * ep_to_dcm: oadcs_dcm_to_ep(oadcs_ep_to_dcm(q)) is the conjugate of q */
+OADCS_API int oadcs_dcm_to_ep(
+    size_t n,
+    const double *R,
+    ptrdiff_t R_stride,
+    double *q,
+    ptrdiff_t q_stride
+);
+
+/* Euler angles (radians, rows of 3) about the axes seq[0..2] (1, 2 or 3) */
+OADCS_API int oadcs_ea_to_dcm(
+    size_t n,
+    const double *angles,
+    ptrdiff_t angles_stride,
+    const int seq[3],
+    double *R,
+    ptrdiff_t R_stride
+);
+
+OADCS_API int oadcs_ea_to_ep(
+    size_t n,
+    const double *angles,
+    ptrdiff_t angles_stride,
+    const int seq[3],
+    double *q,
+    ptrdiff_t q_stride
+);
+
+/* Modified and classical Rodrigues parameters (rows of 3) */
+OADCS_API int oadcs_mrp_to_ep(
+    size_t n,
+    const double *p,
+    ptrdiff_t p_stride,
+    double *q,
+    ptrdiff_t q_stride
+);
+
+OADCS_API int oadcs_crp_to_ep(
+    size_t n,
+    const double *p,
+    ptrdiff_t p_stride,
+    double *q,
+    ptrdiff_t q_stride
+);
+
+/* Euler parameter rates for body rates w (rows of 3, rad/s) */
+OADCS_API int oadcs_ep_kde(
+    size_t n,
+    const double *q,
+    ptrdiff_t q_stride,
+    const double *w,
+    ptrdiff_t w_stride,
+    double *dq,
+    ptrdiff_t dq_stride
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OADCS_H */
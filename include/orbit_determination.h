@@ -0,0 +1,226 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "constants.h"
+#include "dual.h"
+#include "gravity.h"
+#include "parallel.h"
+#include "typedefs.h"
+
+// -----------------------------------------------------------------------------
+// Batch Least Squares Orbit Determination
+// -----------------------------------------------------------------------------
+// Estimates the epoch state x0 from ground station tracking. Each iteration
+//   1. propagates [x, Phi] from t0 through the sorted observation times with
+//      the caller's integrator on STMEOM (one serial pass),
+//   2. evaluates residuals and partials in parallel over fixed blocks of
+//      observations; each block accumulates its own H^T W H and H^T W r,
+//   3. sums the blocks in block order (the result does not depend on the
+//      thread count) and solves the 6x6 normal equations.
+// Measurement partials come from one Dual<6> evaluation of the measurement
+// model, mapped to the epoch with the STM: H = H~(t) Phi(t, t0).
+//
+// The returned x0 is the state the reported rms, residuals and covariance
+// were evaluated at; the last correction is not applied when max_iter runs
+// out.
+//
+// Stations sit on an Earth rotating uniformly about z from gmst0 at t = 0.
+// Light time and aberration are ignored. Observations must not precede t0.
+
+enum class MeasurementType {
+    RANGE,           // km
+    RANGE_RATE,      // km/s
+    RIGHT_ASCENSION, // rad, topocentric
+    DECLINATION,     // rad, topocentric
+};
+
+struct GroundStation {
+    vec3 r_ecef; // km
+};
+
+struct Observation {
+    f64 t;
+    MeasurementType type;
+    int station; // index into the station list
+    f64 value;
+    f64 sigma; // measurement noise, same units as value
+};
+
+struct BatchConfig {
+    int max_iter = 20;
+    f64 tol = 1e-6;       // relative change of the weighted rms
+    f64 gmst0 = 0.;       // Earth rotation angle at t = 0, rad
+    int block_size = 256; // observations per parallel block
+    int n_threads = 0;    // 0 = all cores
+};
+
+struct BatchResult {
+    vec6 x0;                    // estimated epoch state
+    mat6 P;                     // formal covariance
+    f64 rms = 0.;               // weighted rms of the last residuals
+    int iterations = 0;
+    std::vector<f64> residuals; // observed - computed, input order
+};
+
+// Inertial station position and velocity at t
+inline vec6 station_state(const GroundStation &st, f64 t, f64 gmst0) {
+    f64 theta = gmst0 + omega_earth * t;
+    f64 c = std::cos(theta);
+    f64 s = std::sin(theta);
+    vec3 r(
+        c * st.r_ecef(0) - s * st.r_ecef(1),
+        s * st.r_ecef(0) + c * st.r_ecef(1),
+        st.r_ecef(2)
+    );
+    vec6 x;
+    x << r, -omega_earth * r(1), omega_earth * r(0), 0.;
+    return x;
+}
+
+// Modeled measurement for satellite state x seen from station state xs
+template <typename S>
+S predict_measurement(
+    MeasurementType type,
+    const vec6t<S> &x,
+    const vec6 &xs
+) {
+    using std::atan2;
+    using std::sqrt;
+    vec3t<S> rho = x.template head<3>() - xs.head<3>().cast<S>();
+
+    switch (type) {
+    case MeasurementType::RANGE:
+        return rho.norm();
+    case MeasurementType::RANGE_RATE: {
+        vec3t<S> rho_dot = x.template segment<3>(3) - xs.tail<3>().cast<S>();
+        return rho.dot(rho_dot) / rho.norm();
+    }
+    case MeasurementType::RIGHT_ASCENSION:
+        return atan2(rho(1), rho(0));
+    case MeasurementType::DECLINATION:
+        return atan2(rho(2), sqrt(rho(0) * rho(0) + rho(1) * rho(1)));
+    }
+    return S(0.);
+}
+
+// Integrator is a Fixed/AdaptiveStepIntegrator over vec42 with an STMEOM
+template <typename Integrator>
+BatchResult batch_least_squares(
+    const Integrator &integ,
+    f64 t0,
+    const vec6 &x0_guess,
+    const std::vector<Observation> &obs,
+    const std::vector<GroundStation> &stations,
+    const BatchConfig &cfg = {}
+) {
+    const int n_obs = static_cast<int>(obs.size());
+    if (n_obs == 0) {
+        throw std::runtime_error("Batch least squares needs observations");
+    }
+
+    // Observations in time order, grouped by distinct epoch
+    std::vector<int> order(n_obs);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return obs[a].t < obs[b].t;
+    });
+    if (obs[order.front()].t < t0) {
+        throw std::runtime_error("Observation precedes the estimation epoch");
+    }
+    std::vector<f64> epochs;
+    std::vector<int> epoch_of(n_obs);
+    for (int i : order) {
+        if (epochs.empty() || obs[i].t != epochs.back()) {
+            epochs.push_back(obs[i].t);
+        }
+        epoch_of[i] = static_cast<int>(epochs.size()) - 1;
+    }
+
+    struct Normal {
+        mat6 A = mat6::Zero();
+        vec6 b = vec6::Zero();
+        f64 ss = 0.;
+    };
+    const int n_blocks = (n_obs + cfg.block_size - 1) / cfg.block_size;
+    std::vector<Normal> blocks(n_blocks);
+    std::vector<vec42> Y(epochs.size());
+    std::vector<f64> times;
+    std::vector<vec42> states;
+
+    BatchResult res;
+    res.x0 = x0_guess;
+    res.residuals.resize(n_obs);
+    f64 rms_prev = 0.;
+
+    for (int it = 0; it < cfg.max_iter; it++) {
+        // State and STM at every observation epoch
+        Integrator local = integ;
+        vec42 y = stm_initial(res.x0);
+        f64 t = t0;
+        for (size_t e = 0; e < epochs.size(); e++) {
+            local.integrate(t, epochs[e], y, times, states);
+            y = states.back();
+            t = epochs[e];
+            Y[e] = y;
+        }
+
+        // Residuals and normal equations per block
+        parallel_for(
+            n_blocks,
+            [&](int k) {
+                Normal nk;
+                int end = std::min(n_obs, (k + 1) * cfg.block_size);
+                for (int j = k * cfg.block_size; j < end; j++) {
+                    int i = order[j];
+                    const Observation &o = obs[i];
+                    const vec42 &yi = Y[epoch_of[i]];
+                    vec6 xs
+                        = station_state(stations[o.station], o.t, cfg.gmst0);
+
+                    Dual<6> z = predict_measurement(
+                        o.type, dual_variables<6>(yi.head<6>()), xs
+                    );
+                    f64 r = o.value - z.v;
+                    if (o.type == MeasurementType::RIGHT_ASCENSION) {
+                        r = std::remainder(r, twopi);
+                    }
+
+                    eig::Map<const mat6> Phi(yi.data() + 6);
+                    vec6 H = Phi.transpose() * z.d.matrix();
+                    f64 w = 1. / (o.sigma * o.sigma);
+                    nk.A.noalias() += w * H * H.transpose();
+                    nk.b += w * r * H;
+                    nk.ss += w * r * r;
+                    res.residuals[i] = r;
+                }
+                blocks[k] = nk;
+            },
+            cfg.n_threads
+        );
+
+        Normal total;
+        for (const Normal &nk : blocks) {
+            total.A += nk.A;
+            total.b += nk.b;
+            total.ss += nk.ss;
+        }
+
+        res.rms = std::sqrt(total.ss / n_obs);
+        res.P = total.A.inverse();
+        res.iterations = it + 1;
+        if (it > 0 && std::abs(res.rms - rms_prev) <= cfg.tol * rms_prev) {
+            break;
+        }
+        rms_prev = res.rms;
+        if (it + 1 == cfg.max_iter) {
+            break; // keep x0, rms and residuals consistent
+        }
+        res.x0 += total.A.ldlt().solve(total.b);
+    }
+    return res;
+}
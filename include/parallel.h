@@ -0,0 +1,160 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+inline int hardware_threads() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n > 0 ? static_cast<int>(n) : 1;
+}
+
+// -----------------------------------------------------------------------------
+// Thread Pool
+// -----------------------------------------------------------------------------
+// Workers that live for the whole program, so a loop that runs parallel work
+// on every tick does not create and join threads each time. One job runs at
+// a time: try_run returns false while another caller (or a job calling back
+// into the pool) holds it, and that caller then uses threads of its own.
+
+class ThreadPool {
+  public:
+    explicit ThreadPool(int n_workers) {
+        workers_.reserve(std::max(n_workers, 0));
+        for (int k = 0; k < n_workers; k++) {
+            workers_.emplace_back([this, k] { loop(k); });
+        }
+    }
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto &th : workers_) {
+            th.join();
+        }
+    }
+
+    int size() const { return static_cast<int>(workers_.size()); }
+
+    // Runs work on the calling thread and on n_workers pool workers and
+    // returns once all of them finished. work must not throw.
+    bool try_run(int n_workers, const std::function<void()> &work) {
+        std::unique_lock owner(owner_, std::try_to_lock);
+        if (!owner || n_workers > size()) {
+            return false;
+        }
+        {
+            std::lock_guard lock(mutex_);
+            job_ = &work;
+            active_ = n_workers;
+            pending_ = n_workers;
+            generation_++;
+        }
+        wake_.notify_all();
+        work();
+
+        std::unique_lock lock(mutex_);
+        done_.wait(lock, [this] { return pending_ == 0; });
+        job_ = nullptr;
+        return true;
+    }
+
+  private:
+    std::vector<std::thread> workers_;
+    std::mutex owner_; // held by the caller of the running job
+    std::mutex mutex_;
+    std::condition_variable wake_, done_;
+    const std::function<void()> *job_ = nullptr;
+    int active_ = 0;  // workers taking part in the current job
+    int pending_ = 0; // of those, workers still running it
+    unsigned long generation_ = 0;
+    bool stop_ = false;
+
+    void loop(int k) {
+        unsigned long seen = 0;
+        std::unique_lock lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+            if (stop_) {
+                return;
+            }
+            seen = generation_;
+            if (k >= active_) {
+                continue;
+            }
+            const std::function<void()> *job = job_;
+            lock.unlock();
+            (*job)();
+            lock.lock();
+            if (--pending_ == 0) {
+                done_.notify_one();
+            }
+        }
+    }
+};
+
+// Pool shared by every parallel_for, one worker per core besides the caller
+inline ThreadPool &shared_pool() {
+    static ThreadPool pool(hardware_threads() - 1);
+    return pool;
+}
+
+// Run fn(i) for i in [0, n) on n_threads workers (0 = all cores). Indices are
+// handed out dynamically; the first exception thrown by any worker is
+// rethrown on the calling thread once all workers have stopped. The workers
+// come from shared_pool(), or are started for this call when the pool is
+// busy or too small.
+template <typename Fn> void parallel_for(int n, Fn &&fn, int n_threads = 0) {
+    if (n_threads <= 0) {
+        n_threads = hardware_threads();
+    }
+    n_threads = std::min(n_threads, n);
+    if (n_threads <= 1) {
+        for (int i = 0; i < n; i++) {
+            fn(i);
+        }
+        return;
+    }
+
+    std::atomic<int> next{0};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    std::function<void()> worker = [&]() {
+        try {
+            for (int i = next++; i < n; i = next++) {
+                fn(i);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+            next = n;
+        }
+    };
+
+    if (!shared_pool().try_run(n_threads - 1, worker)) {
+        std::vector<std::thread> pool;
+        pool.reserve(n_threads - 1);
+        for (int k = 1; k < n_threads; k++) {
+            pool.emplace_back(worker);
+        }
+        worker();
+        for (auto &th : pool) {
+            th.join();
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
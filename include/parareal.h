@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "parallel.h"
+#include "typedefs.h"
+
+// -----------------------------------------------------------------------------
+// Parareal
+// -----------------------------------------------------------------------------
+// Parallel-in-time propagation of one arc. [t0, tf] is cut into n_slices
+// slices. A cheap coarse propagator G sweeps serially across the slice
+// boundaries and the expensive fine propagator F refines every slice in
+// parallel; each iteration applies the correction
+//
+//   U[n+1] = G(U[n]) + F(U_old[n]) - G(U_old[n])
+//
+// After k iterations the first k boundaries equal the serial fine solution,
+// so those slices are skipped. With K iterations to converge the wall time is
+// about K fine slices plus K coarse sweeps, i.e. a speedup of up to
+// n_slices / K when there are n_slices cores.
+//
+// Propagators are callables x(tb) = P(ta, tb, x(ta)). The fine propagator is
+// called concurrently and must not share mutable state between calls
+// (integrator_flow below copies the integrator per call).
+
+struct PararealConfig {
+    int n_slices = 0;  // 0 = one per thread
+    int max_iter = 10; // at most n_slices iterations are ever needed
+    f64 tol = 1e-6;    // max boundary update, in state units
+    int n_threads = 0; // 0 = all cores
+};
+
+template <typename State> struct PararealResult {
+    std::vector<f64> times;    // slice boundaries
+    std::vector<State> states; // states at the boundaries
+    int iterations = 0;
+    f64 update = 0.; // max boundary change in the last iteration
+};
+
+// Flow map from an integrator (FixedStepIntegrator/AdaptiveStepIntegrator)
+template <typename State, typename Integrator>
+auto integrator_flow(const Integrator &integ) {
+    return [integ](f64 ta, f64 tb, const State &xa) {
+        Integrator local = integ;
+        std::vector<f64> times;
+        std::vector<State> states;
+        local.integrate(ta, tb, xa, times, states);
+        return states.back();
+    };
+}
+
+template <typename State, typename Coarse, typename Fine>
+PararealResult<State> parareal(
+    const Coarse &G,
+    const Fine &F,
+    f64 t0,
+    f64 tf,
+    const State &x0,
+    PararealConfig cfg = {}
+) {
+    int N = cfg.n_slices > 0 ? cfg.n_slices
+                             : (cfg.n_threads > 0 ? cfg.n_threads
+                                                  : hardware_threads());
+
+    PararealResult<State> res;
+    res.times.resize(N + 1);
+    for (int n = 0; n <= N; n++) {
+        res.times[n] = t0 + (tf - t0) * n / N;
+    }
+    res.times[N] = tf;
+    const std::vector<f64> &t = res.times;
+
+    // Initial coarse sweep
+    std::vector<State> &U = res.states;
+    std::vector<State> g(N), f(N);
+    U.resize(N + 1);
+    U[0] = x0;
+    for (int n = 0; n < N; n++) {
+        g[n] = G(t[n], t[n + 1], U[n]);
+        U[n + 1] = g[n];
+    }
+
+    for (int k = 0; k < std::min(cfg.max_iter, N); k++) {
+        // Fine solves on the slices that are not yet exact
+        parallel_for(
+            N - k,
+            [&](int i) {
+                int n = k + i;
+                f[n] = F(t[n], t[n + 1], U[n]);
+            },
+            cfg.n_threads
+        );
+
+        // Serial coarse sweep with the correction
+        f64 update = (f[k] - U[k + 1]).norm();
+        U[k + 1] = f[k];
+        for (int n = k + 1; n < N; n++) {
+            State g_new = G(t[n], t[n + 1], U[n]);
+            State u_new = g_new + f[n] - g[n];
+            update = std::max(update, (u_new - U[n + 1]).norm());
+            g[n] = g_new;
+            U[n + 1] = u_new;
+        }
+
+        res.iterations = k + 1;
+        res.update = update;
+        if (update <= cfg.tol) {
+            break;
+        }
+    }
+    return res;
+}
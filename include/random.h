@@ -0,0 +1,227 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+#include "constants.h"
+#include "simd.h"
+#include "typedefs.h"
+
+// -----------------------------------------------------------------------------
+// Counter-Based Random Numbers
+// -----------------------------------------------------------------------------
+// Philox4x32-10 (Salmon et al. 2011, Random123): a keyed bijection of a
+// 128-bit counter, so every variate is a pure function of (seed, channel,
+// run, case, sample, index). Each worker builds its own RandomStream for the
+// work item it is processing and the numbers come out identical for any
+// thread count or scheduling, with no shared state and no locks.
+//
+// counter = {block, sample, case, run}, key = splitmix64 of the seed and a
+// channel id (e.g. one channel each for the dispersion, the gyro and the
+// star tracker), so distinct channels of one seed, or seeds of one channel,
+// never share a key. One block gives two uniforms or two normals
+// (Box-Muller).
+//
+// The batch fills lay out a run of counters as structure of arrays and hand
+// them to the philox4x32 SIMD kernel (simd.h), 8 (AVX2) or 16 (AVX-512)
+// counters per vector. They give the same numbers as the scalar draws.
+
+namespace detail {
+constexpr u32 philox_m0 = 0xD2511F53;
+constexpr u32 philox_m1 = 0xCD9E8D57;
+constexpr u32 philox_w0 = 0x9E3779B9;
+constexpr u32 philox_w1 = 0xBB67AE85;
+
+// Finalizer of splitmix64 (Steele et al. 2014), a bijection of u64
+inline u64 splitmix64(u64 x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// Philox key for a seed and channel
+inline u64 philox_key(u64 seed, u32 channel) {
+    return splitmix64(splitmix64(seed) + channel);
+}
+
+// Uniform in (0, 1) from two words (52 random bits), never exactly 0 or 1.
+// The mantissa is filled directly instead of converting an integer, which
+// keeps the conversion vectorizable without AVX-512.
+inline f64 u01(u32 hi, u32 lo) {
+    u64 bits = 0x3FF0000000000000ull | (((u64(hi) << 32) | lo) >> 12);
+    f64 x;
+    std::memcpy(&x, &bits, sizeof(x));
+    return (x - 1.) + 0x1p-53;
+}
+
+// Box-Muller pair
+inline void box_muller(f64 u1, f64 u2, f64 &z0, f64 &z1) {
+    f64 r = std::sqrt(-2. * std::log(u1));
+    z0 = r * std::cos(twopi * u2);
+    z1 = r * std::sin(twopi * u2);
+}
+} // namespace detail
+
+inline std::array<u32, 4>
+philox4x32(const std::array<u32, 4> &ctr, const std::array<u32, 2> &key) {
+    u32 c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+    u32 k0 = key[0], k1 = key[1];
+    for (int r = 0; r < 10; r++) {
+        u64 p0 = u64(detail::philox_m0) * c0;
+        u64 p1 = u64(detail::philox_m1) * c2;
+        c0 = u32(p1 >> 32) ^ c1 ^ k0;
+        c1 = u32(p1);
+        c2 = u32(p0 >> 32) ^ c3 ^ k1;
+        c3 = u32(p0);
+        k0 += detail::philox_w0;
+        k1 += detail::philox_w1;
+    }
+    return {c0, c1, c2, c3};
+}
+
+struct RandomStream {
+    static constexpr int B = 64; // blocks per kernel call
+
+    u32 k0, k1;
+    u32 sample, case_id, run;
+    u32 block = 0;
+
+    // Scalar draws consume half a block at a time
+    std::array<u32, 4> buf{};
+    int half = 2;
+    f64 spare_normal = 0.;
+    bool has_spare = false;
+
+    RandomStream(
+        u64 seed,
+        u32 run,
+        u32 case_id,
+        u32 sample,
+        u32 channel = 0
+    )
+        : k0(u32(detail::philox_key(seed, channel))),
+          k1(u32(detail::philox_key(seed, channel) >> 32)), sample(sample),
+          case_id(case_id), run(run) {};
+
+    std::array<u32, 4> next_block() {
+        return philox4x32({block++, sample, case_id, run}, {k0, k1});
+    }
+
+    f64 uniform() {
+        if (half == 2) {
+            buf = next_block();
+            half = 0;
+        }
+        f64 u = detail::u01(buf[2 * half], buf[2 * half + 1]);
+        half++;
+        return u;
+    }
+
+    f64 normal() {
+        if (has_spare) {
+            has_spare = false;
+            return spare_normal;
+        }
+        f64 u1 = uniform();
+        f64 u2 = uniform();
+        f64 z0;
+        detail::box_muller(u1, u2, z0, spare_normal);
+        has_spare = true;
+        return z0;
+    }
+
+    template <int N> eig::Matrix<f64, N, 1> normal_vec() {
+        eig::Matrix<f64, N, 1> z;
+        for (int i = 0; i < N; i++) {
+            z(i) = normal();
+        }
+        return z;
+    }
+
+    // Batch fills start on a fresh block (scalar leftovers are dropped)
+    void fill_uniform(f64 *out, size_t n) { fill(out, n, false); }
+    void fill_normal(f64 *out, size_t n) { fill(out, n, true); }
+
+  private:
+    void fill(f64 *out, size_t n, bool gaussian) {
+        half = 2;
+        has_spare = false;
+        const SimdKernels &K = simd_kernels();
+        for (size_t i = 0; i < n; i += 2 * B) {
+            size_t m = std::min(n - i, size_t(2 * B));
+            size_t nb = (m + 1) / 2;
+
+            u32 ctr[4 * B], c[4 * B];
+            for (size_t l = 0; l < nb; l++) {
+                ctr[l] = block + static_cast<u32>(l);
+                ctr[nb + l] = sample;
+                ctr[2 * nb + l] = case_id;
+                ctr[3 * nb + l] = run;
+            }
+            K.philox4x32(nb, ctr, c, k0, k1);
+
+            f64 v[2 * B];
+            for (size_t l = 0; l < nb; l++) {
+                v[2 * l] = detail::u01(c[l], c[nb + l]);
+                v[2 * l + 1] = detail::u01(c[2 * nb + l], c[3 * nb + l]);
+            }
+            if (gaussian) {
+                for (size_t l = 0; l < nb; l++) {
+                    f64 u1 = v[2 * l];
+                    f64 u2 = v[2 * l + 1];
+                    detail::box_muller(u1, u2, v[2 * l], v[2 * l + 1]);
+                }
+            }
+
+            std::copy(v, v + m, out + i);
+            block += static_cast<u32>(nb);
+        }
+    }
+};
+
+// -----------------------------------------------------------------------------
+// Dispersions and Sensor Noise
+// -----------------------------------------------------------------------------
+
+// mean + L z with L the lower Cholesky factor of the covariance
+template <int N>
+eig::Matrix<f64, N, 1> disperse(
+    const eig::Matrix<f64, N, 1> &mean,
+    const eig::Matrix<f64, N, N> &L,
+    RandomStream &rs
+) {
+    return mean + L * rs.normal_vec<N>();
+}
+
+// Rate integrating gyro (Markley & Crassidis 4.7): angle random walk sigma_v
+// (rad/s^(1/2)) and bias random walk sigma_u (rad/s^(3/2)). The bias evolves
+// with each measure() call, draws come from the stream passed in (typically
+// keyed by the time step as the sample).
+struct GyroNoise {
+    f64 sigma_v;
+    f64 sigma_u;
+    vec3 bias;
+
+    vec3 measure(const vec3 &omega, f64 dt, RandomStream &rs) {
+        vec3 bias_next = bias + sigma_u * std::sqrt(dt) * rs.normal_vec<3>();
+        f64 s = std::sqrt(
+            sigma_v * sigma_v / dt + sigma_u * sigma_u * dt / 12.
+        );
+        vec3 w = omega + 0.5 * (bias + bias_next) + s * rs.normal_vec<3>();
+        bias = bias_next;
+        return w;
+    }
+};
+
+// Line of sight with isotropic angular noise sigma (rad) per axis
+struct StarTrackerNoise {
+    f64 sigma;
+
+    vec3 measure(const vec3 &b, RandomStream &rs) const {
+        return (b + sigma * rs.normal_vec<3>()).normalized();
+    }
+};
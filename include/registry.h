@@ -0,0 +1,233 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "FixedIntegrators.h"
+#include "attitude.h"
+#include "parallel.h"
+#include "typedefs.h"
+#include "units.h"
+
+// -----------------------------------------------------------------------------
+// Entity Registry
+// -----------------------------------------------------------------------------
+// Every body (satellite, celestial body, ...) is an entity id. Its components
+// live in separate arrays indexed by that id: translational state, attitude
+// state, mass properties and cold metadata (name, units). A system only
+// touches the arrays it needs, so propagating a fleet streams through pos/vel
+// without dragging names and flags through the cache.
+//
+// Which systems run on an entity is recorded by membership in an EntitySet
+// (translating, rotating, output) rather than per-entity flags, and systems
+// loop densely over the members of their set.
+
+using Entity = u32;
+
+enum class EntityKind {
+    SATELLITE,
+    CELESTIAL_BODY,
+};
+
+// Sparse set of entity ids: members are packed in insertion order for
+// iteration (an erase moves the last member into the gap), sparse maps an id
+// to its slot.
+struct EntitySet {
+    static constexpr u32 npos = ~u32(0);
+
+    std::vector<Entity> dense;
+    std::vector<u32> sparse;
+
+    bool contains(Entity e) const {
+        return e < sparse.size() && sparse[e] != npos;
+    }
+
+    void insert(Entity e) {
+        if (contains(e)) {
+            return;
+        }
+        if (e >= sparse.size()) {
+            sparse.resize(e + 1, npos);
+        }
+        sparse[e] = static_cast<u32>(dense.size());
+        dense.push_back(e);
+    }
+
+    void erase(Entity e) {
+        if (!contains(e)) {
+            return;
+        }
+        u32 slot = sparse[e];
+        Entity last = dense.back();
+        dense[slot] = last;
+        sparse[last] = slot;
+        dense.pop_back();
+        sparse[e] = npos;
+    }
+
+    size_t size() const { return dense.size(); }
+    bool empty() const { return dense.empty(); }
+    auto begin() const { return dense.begin(); }
+    auto end() const { return dense.end(); }
+    Entity operator[](size_t i) const { return dense[i]; }
+};
+
+// Cold data, only read for setup and output
+struct EntityInfo {
+    std::string name;
+    EntityKind kind = EntityKind::SATELLITE;
+    UnitsLinear u_linear = UnitsLinear::KILOMETER;
+    UnitsAngle u_angle = UnitsAngle::RADIANS;
+    UnitsMass u_mass = UnitsMass::KILOGRAMS;
+};
+
+struct Registry {
+    // Translational state
+    std::vector<vec3> pos;
+    std::vector<vec3> vel;
+
+    // Attitude state
+    std::vector<vec4> ep; // euler param/quaternions
+    std::vector<vec3> omega;
+
+    // Mass properties
+    std::vector<f64> mass;
+    std::vector<mat3> inertia;
+    std::vector<mat3> inertia_inv;
+
+    // Metadata
+    std::vector<EntityInfo> info;
+
+    // System membership
+    EntitySet translating; // propagated by translation_step
+    EntitySet rotating;    // propagated by attitude_step
+    EntitySet output;      // written by write_states
+
+    size_t size() const { return info.size(); }
+
+    // New entity at rest at the origin, identity attitude, unit mass and
+    // inertia. It starts out translating only.
+    Entity create(std::string name, EntityKind kind = EntityKind::SATELLITE) {
+        Entity e = static_cast<Entity>(size());
+        pos.push_back(vec3::Zero());
+        vel.push_back(vec3::Zero());
+        ep.push_back(vec4(0., 0., 0., 1.));
+        omega.push_back(vec3::Zero());
+        mass.push_back(1.);
+        inertia.push_back(mat3::Identity());
+        inertia_inv.push_back(mat3::Identity());
+        info.push_back({std::move(name), kind});
+        translating.insert(e);
+        return e;
+    }
+
+    vec6 state(Entity e) const {
+        vec6 x;
+        x << pos[e], vel[e];
+        return x;
+    }
+
+    void set_state(Entity e, const vec6 &x) {
+        pos[e] = x.head<3>();
+        vel[e] = x.tail<3>();
+    }
+
+    void set_inertia(Entity e, const mat3 &I) {
+        inertia[e] = I;
+        inertia_inv[e] = I.inverse();
+    }
+};
+
+// -----------------------------------------------------------------------------
+// Systems
+// -----------------------------------------------------------------------------
+// One force model serves every entity, and every worker thread, through a
+// const reference. Its policies must therefore be pure functions of (t, x):
+// nothing may carry over from one entity's evaluation to the next.
+
+// Acceleration of every translating entity, acc[i] for member i of
+// reg.translating
+template <typename ForcePolicy>
+void gravity_system(
+    const Registry &reg,
+    const ForcePolicy &forces,
+    f64 t,
+    std::vector<vec3> &acc
+) {
+    acc.resize(reg.translating.size());
+    for (size_t i = 0; i < reg.translating.size(); i++) {
+        acc[i] = forces.acceleration(t, reg.state(reg.translating[i]));
+    }
+}
+
+// One fixed step of the translating entities under forces, in parallel over
+// entities (Policy is one of the fixed-step policies, RK4 by default)
+template <
+    template <typename, typename> class Policy = RK4Policy,
+    typename ForcePolicy>
+void translation_step(
+    Registry &reg,
+    const ForcePolicy &forces,
+    f64 t,
+    f64 dt,
+    int n_threads = 1
+) {
+    auto f = [&forces](f64 tt, const vec6 &x) {
+        vec6 dxdt;
+        dxdt << x.tail<3>(), forces.acceleration(tt, x);
+        return dxdt;
+    };
+    using Step = Policy<decltype(f), vec6>;
+    parallel_for(
+        static_cast<int>(reg.translating.size()),
+        [&](int i) {
+            Entity e = reg.translating[i];
+            reg.set_state(e, Step::step(f, t, reg.state(e), dt).second);
+        },
+        n_threads
+    );
+}
+
+// One fixed step of the rotating entities, torque free, quaternion
+// renormalized after the step
+template <template <typename, typename> class Policy = RK4Policy>
+void attitude_step(Registry &reg, f64 t, f64 dt, int n_threads = 1) {
+    parallel_for(
+        static_cast<int>(reg.rotating.size()),
+        [&](int i) {
+            Entity e = reg.rotating[i];
+            const mat3 &I = reg.inertia[e];
+            const mat3 &I_inv = reg.inertia_inv[e];
+            bool I_diag = I.isDiagonal();
+            const vec3 torque = vec3::Zero();
+            auto f = [&](f64, const vec7 &x) {
+                vec4 q = x.head<4>();
+                vec3 w = x.tail<3>();
+                vec7 dxdt;
+                dxdt << ep_kde(q, w),
+                    omega_ode(w, torque, I, I_inv, I_diag);
+                return dxdt;
+            };
+
+            vec7 x;
+            x << reg.ep[e], reg.omega[e];
+            vec7 x_new = Policy<decltype(f), vec7>::step(f, t, x, dt).second;
+            reg.ep[e] = x_new.head<4>().normalized();
+            reg.omega[e] = x_new.tail<3>();
+        },
+        n_threads
+    );
+}
+
+// CSV rows "t,name,x,y,z,vx,vy,vz,q1,q2,q3,q4" for the output entities
+inline void write_states(const Registry &reg, f64 t, std::ostream &os) {
+    for (Entity e : reg.output) {
+        const vec3 &r = reg.pos[e];
+        const vec3 &v = reg.vel[e];
+        const vec4 &q = reg.ep[e];
+        os << t << ',' << reg.info[e].name << ',' << r(0) << ',' << r(1)
+           << ',' << r(2) << ',' << v(0) << ',' << v(1) << ',' << v(2) << ','
+           << q(0) << ',' << q(1) << ',' << q(2) << ',' << q(3) << '\n';
+    }
+}
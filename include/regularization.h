@@ -0,0 +1,238 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <utility>
+
+#include "constants.h"
+#include "typedefs.h"
+
+// -----------------------------------------------------------------------------
+// Regularized Equations of Motion
+// -----------------------------------------------------------------------------
+// Both formulations replace physical time t with a fictitious time s and carry
+// t as an extra state component, so they plug into FixedStepIntegrator and
+// AdaptiveStepIntegrator unchanged: the integrator's "times" are s values and
+// the physical time is read back from the state.
+//
+// Sundman: dt/ds = c * r^n, state [r, v, t] (vec7)
+//   n = 1   -> s proportional to eccentric anomaly
+//   n = 3/2 -> s proportional to intermediate anomaly
+//   n = 2   -> s proportional to true anomaly
+// Kustaanheimo-Stiefel: dt/ds = r, state [u, u', h, t] (vec10), where h is the
+// negative Kepler energy. The Kepler part is linear (harmonic oscillator) and
+// only perturbations drive h and the right hand side.
+//
+// ForcePolicy is the same full force model used with EOM (i.e. it includes
+// the central body); the KS form removes the Keplerian term internally.
+
+// Sundman transformed state [r, v, t]
+inline vec7 to_sundman(const vec6 &x, f64 t) {
+    vec7 y;
+    y << x, t;
+    return y;
+}
+inline vec6 from_sundman(const vec7 &y) { return y.head<6>(); }
+
+template <typename ForcePolicy> struct SundmanEOM {
+    ForcePolicy forces;
+    f64 c; // scale factor
+    f64 n; // exponent of r
+
+    explicit SundmanEOM(const ForcePolicy &fp, f64 c = 1., f64 n = 1.)
+        : forces(fp), c(c), n(n) {};
+
+    // Time dilation dt/ds
+    f64 dtds(f64 r) const {
+        if (n == 1.) {
+            return c * r;
+        } else if (n == 2.) {
+            return c * r * r;
+        } else if (n == 1.5) {
+            return c * r * std::sqrt(r);
+        }
+        return c * std::pow(r, n);
+    }
+
+    vec7 operator()(f64 s, const vec7 &y) const {
+        vec6 x = y.head<6>();
+        f64 w = dtds(x.head<3>().norm());
+
+        vec7 dyds;
+        dyds << w * x.segment<3>(3), w * forces.acceleration(y(6), x), w;
+        return dyds;
+    }
+};
+
+// -----------------------------------------------------------------------------
+// Kustaanheimo-Stiefel
+// -----------------------------------------------------------------------------
+
+// KS matrix L(u), x = L(u) u with x(3) = 0
+inline mat4 ks_matrix(const vec4 &u) {
+    mat4 L;
+    L << u(0), -u(1), -u(2), u(3), //
+        u(1), u(0), -u(3), -u(2),  //
+        u(2), u(3), u(0), u(1),    //
+        u(3), -u(2), u(1), -u(0);
+    return L;
+}
+
+// Cartesian state -> KS state [u, u', h, t]
+inline vec10 cart_to_ks(const vec6 &x, f64 t, f64 mu) {
+    vec3 r = x.head<3>();
+    vec3 v = x.segment<3>(3);
+    f64 r_mag = r.norm();
+
+    // Choose the branch that keeps the square root well conditioned
+    vec4 u;
+    if (r(0) >= 0.) {
+        f64 u1 = std::sqrt(0.5 * (r_mag + r(0)));
+        u << u1, r(1) / (2. * u1), r(2) / (2. * u1), 0.;
+    } else {
+        f64 u2 = std::sqrt(0.5 * (r_mag - r(0)));
+        u << r(1) / (2. * u2), u2, 0., r(2) / (2. * u2);
+    }
+
+    vec4 v4;
+    v4 << v, 0.;
+    vec4 up = 0.5 * ks_matrix(u).transpose() * v4;
+    f64 h = mu / r_mag - 0.5 * v.squaredNorm();
+
+    vec10 y;
+    y << u, up, h, t;
+    return y;
+}
+
+// KS state -> Cartesian state
+inline vec6 ks_to_cart(const vec10 &y) {
+    vec4 u = y.segment<4>(0);
+    vec4 up = y.segment<4>(4);
+    f64 r_mag = u.squaredNorm();
+    mat4 L = ks_matrix(u);
+
+    vec6 x;
+    x << (L * u).head<3>(), (2. / r_mag * (L * up)).head<3>();
+    return x;
+}
+
+inline f64 ks_time(const vec10 &y) { return y(9); }
+
+// Bilinear relation, zero along any physical trajectory (drift monitor)
+inline f64 ks_bilinear(const vec10 &y) {
+    return y(3) * y(4) - y(2) * y(5) + y(1) * y(6) - y(0) * y(7);
+}
+
+template <typename ForcePolicy> struct KSEOM {
+    ForcePolicy forces;
+    f64 mu;
+
+    explicit KSEOM(const ForcePolicy &fp, f64 mu) : forces(fp), mu(mu) {};
+
+    vec10 operator()(f64 s, const vec10 &y) const {
+        vec4 u = y.segment<4>(0);
+        vec4 up = y.segment<4>(4);
+        f64 h = y(8);
+        f64 r_mag = u.squaredNorm();
+        mat4 L = ks_matrix(u);
+
+        vec6 x;
+        x << (L * u).head<3>(), (2. / r_mag * (L * up)).head<3>();
+
+        // Perturbing acceleration (total minus Keplerian)
+        vec4 p = vec4::Zero();
+        p.head<3>() = forces.acceleration(y(9), x)
+                      + mu / (r_mag * r_mag * r_mag) * x.head<3>();
+        vec4 Ltp = L.transpose() * p;
+
+        vec10 dyds;
+        dyds << up, -0.5 * h * u + 0.5 * r_mag * Ltp, -2. * up.dot(Ltp), r_mag;
+        return dyds;
+    }
+};
+
+// -----------------------------------------------------------------------------
+// Fictitious Time Span
+// -----------------------------------------------------------------------------
+
+// Fictitious time needed to cover a physical interval dt starting from x0,
+// evaluated on the osculating Kepler orbit (exact for the unperturbed problem).
+// KS uses c = 1, n = 1.
+inline f64
+sundman_span(f64 mu, const vec6 &x0, f64 dt, f64 c = 1., f64 n = 1.) {
+    vec3 r = x0.head<3>();
+    vec3 v = x0.segment<3>(3);
+    f64 r_mag = r.norm();
+    f64 a = 1. / (2. / r_mag - v.squaredNorm() / mu);
+
+    // Not elliptic, fall back to the initial rate
+    if (a <= 0.) {
+        return dt / (c * std::pow(r_mag, n));
+    }
+
+    f64 nm = std::sqrt(mu / (a * a * a));
+    f64 ecosE = 1. - r_mag / a;
+    f64 esinE = r.dot(v) / std::sqrt(mu * a);
+    f64 e = std::sqrt(ecosE * ecosE + esinE * esinE);
+    f64 E0 = std::atan2(esinE, ecosE);
+
+    // Kepler's equation for the final eccentric anomaly (unwrapped)
+    f64 M1 = E0 - esinE + nm * dt;
+    f64 E1 = M1;
+    for (int i = 0; i < 50; i++) {
+        f64 dE = (E1 - e * std::sin(E1) - M1) / (1. - e * std::cos(E1));
+        E1 -= dE;
+        if (std::abs(dE) < 1e-14) {
+            break;
+        }
+    }
+
+    // ds = r^(1 - n) / (c * nm * a) dE
+    f64 k = 1. / (c * nm * a);
+    if (n == 1.) {
+        return k * (E1 - E0);
+    }
+
+    // Composite Simpson in E, integrand is smooth and periodic
+    int N = 2 * std::max(16, static_cast<int>(32. * std::abs(E1 - E0) / pi));
+    f64 h = (E1 - E0) / N;
+    f64 sum = 0.;
+    for (int i = 0; i <= N; i++) {
+        f64 E = E0 + i * h;
+        f64 w = (i == 0 || i == N) ? 1. : (i % 2 ? 4. : 2.);
+        sum += w * std::pow(a * (1. - e * std::cos(E)), 1. - n);
+    }
+    return k * sum * h / 3.;
+}
+
+// Close the remaining physical time gap after integrating over an estimated
+// span: Newton iterations in s, each taken in fixed Policy steps no longer
+// than ds_max. t_idx is the index of the time component of the state.
+template <
+    template <typename, typename> class Policy,
+    typename F,
+    typename State>
+std::pair<f64, State> land_on_time(
+    const F &f,
+    f64 s,
+    State y,
+    f64 tf,
+    int t_idx,
+    f64 ds_max,
+    f64 tol = 1e-9,
+    int max_iter = 8
+) {
+    for (int i = 0; i < max_iter; i++) {
+        f64 dt = tf - y(t_idx);
+        if (std::abs(dt) <= tol) {
+            break;
+        }
+        f64 ds = dt / f(s, y)(t_idx);
+        int N = static_cast<int>(std::ceil(std::abs(ds) / ds_max));
+        for (int j = 0; j < N; j++) {
+            std::tie(s, y) = Policy<F, State>::step(f, s, y, ds / N);
+        }
+    }
+    return {s, y};
+}
@@ -1,11 +0,0 @@
-#pragma once
-
-#include "Body.h"
-
-struct Satellite : public Body {
-
-    // methods
-
-    
-
-};
\ No newline at end of file
@@ -0,0 +1,648 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iomanip>
+#include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "AdaptiveIntegrators.h"
+#include "FixedIntegrators.h"
+#include "constants.h"
+#include "egm_embedded.h"
+#include "ephemeris.h"
+#include "gravity.h"
+#include "integrator.h"
+#include "parallel.h"
+#include "trajectory.h"
+#include "typedefs.h"
+
+// -----------------------------------------------------------------------------
+// Scenario Files
+// -----------------------------------------------------------------------------
+// One propagation per file, as `key = value` lines; `#` starts a comment and
+// vectors are whitespace separated. Units are km, km/s and s.
+//
+//   name       = leo_8x8            # default: file name without extension
+//   mu         = 398600.4418        # default: mu_earth
+//   R          = 6378.137           # default: r_earth
+//   r0         = 7000 0 0           # required
+//   v0         = 0 7.546 0          # required
+//   t0         = 0
+//   tf         = 5400               # required
+//   integrator = rk4                # rk1..rk6, heun, ralston, dp45
+//   dt         = 10                 # step (initial step for dp45)
+//   tol        = 1e-9               # dp45 error tolerance
+//   gravity    = EGM84              # point, EGM84, EGM96 or EGM2008
+//   degree     = 8                  # order defaults to degree
+//   order      = 8
+//   gravity_tol = 0                 # degree truncation budget, km/s^2
+//   jd0        = 2451545.0          # Julian date at t = 0
+//   third_body = sun moon           # any of sun, moon
+//   output     = leo_8x8.csv        # default: <name>.csv in the output dir
+//   output_every = 1                # write every k-th step (and the last)
+//
+// Unknown keys and malformed values are errors, reported as file:line.
+
+enum class IntegratorKind {
+    RK1,
+    RK2,
+    RK3,
+    RK4,
+    RK5,
+    RK6,
+    HEUN,
+    RALSTON,
+    DP45,
+};
+
+struct Scenario {
+    std::string name;
+    std::string source; // file it was read from
+    f64 mu = mu_earth;
+    f64 R = r_earth;
+    vec3 r0 = vec3::Zero();
+    vec3 v0 = vec3::Zero();
+    f64 t0 = 0.;
+    f64 tf = 0.;
+    IntegratorKind integrator = IntegratorKind::RK4;
+    f64 dt = 10.;
+    f64 tol = 1e-9;
+    std::string gravity = "point";
+    int degree = 0;
+    int order = 0;
+    f64 gravity_tol = 0.;
+    f64 jd0 = jd_j2000;
+    bool sun = false;
+    bool moon = false;
+    std::string output;
+    int output_every = 1;
+
+    vec6 state() const {
+        vec6 x;
+        x << r0, v0;
+        return x;
+    }
+    bool needs_ephemeris() const { return sun || moon; }
+};
+
+namespace detail {
+inline std::string trim(const std::string &s) {
+    size_t a = s.find_first_not_of(" \t\r");
+    size_t b = s.find_last_not_of(" \t\r");
+    return a == std::string::npos ? "" : s.substr(a, b - a + 1);
+}
+
+inline std::vector<std::string> words(const std::string &s) {
+    std::istringstream is(s);
+    std::vector<std::string> out;
+    for (std::string w; is >> w;) {
+        out.push_back(w);
+    }
+    return out;
+}
+
+inline f64 parse_f64(const std::string &s) {
+    size_t used = 0;
+    f64 v = std::stod(s, &used);
+    if (used != s.size()) {
+        throw std::invalid_argument(s);
+    }
+    return v;
+}
+
+inline int parse_int(const std::string &s) {
+    size_t used = 0;
+    int v = std::stoi(s, &used);
+    if (used != s.size()) {
+        throw std::invalid_argument(s);
+    }
+    return v;
+}
+
+inline vec3 parse_vec3(const std::string &s) {
+    std::vector<std::string> w = words(s);
+    if (w.size() != 3) {
+        throw std::invalid_argument("expected 3 values");
+    }
+    return vec3(parse_f64(w[0]), parse_f64(w[1]), parse_f64(w[2]));
+}
+
+inline IntegratorKind parse_integrator(const std::string &s) {
+    static const std::map<std::string, IntegratorKind> kinds{
+        {"rk1", IntegratorKind::RK1},
+        {"rk2", IntegratorKind::RK2},
+        {"rk3", IntegratorKind::RK3},
+        {"rk4", IntegratorKind::RK4},
+        {"rk5", IntegratorKind::RK5},
+        {"rk6", IntegratorKind::RK6},
+        {"heun", IntegratorKind::HEUN},
+        {"ralston", IntegratorKind::RALSTON},
+        {"dp45", IntegratorKind::DP45},
+    };
+    auto it = kinds.find(s);
+    if (it == kinds.end()) {
+        throw std::invalid_argument("unknown integrator " + s);
+    }
+    return it->second;
+}
+
+// Model year of a gravity model name, 0 for a point mass
+inline int gravity_year(const std::string &model) {
+    if (model == "point") {
+        return 0;
+    }
+    if (model == "EGM84") {
+        return 1984;
+    }
+    if (model == "EGM96") {
+        return 1996;
+    }
+    if (model == "EGM2008") {
+        return 2008;
+    }
+    throw std::invalid_argument("unknown gravity model " + model);
+}
+} // namespace detail
+
+inline Scenario parse_scenario(std::istream &is, const std::string &source) {
+    Scenario s;
+    s.source = source;
+    s.name = std::filesystem::path(source).stem().string();
+    bool has_r0 = false, has_v0 = false, has_tf = false, has_order = false;
+
+    std::string line;
+    for (int n = 1; std::getline(is, line); n++) {
+        line = detail::trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+        auto err = [&](const std::string &msg) {
+            return std::runtime_error(
+                source + ":" + std::to_string(n) + ": " + msg
+            );
+        };
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            throw err("expected key = value");
+        }
+        std::string key = detail::trim(line.substr(0, eq));
+        std::string val = detail::trim(line.substr(eq + 1));
+
+        try {
+            if (key == "name") {
+                s.name = val;
+            } else if (key == "mu") {
+                s.mu = detail::parse_f64(val);
+            } else if (key == "R") {
+                s.R = detail::parse_f64(val);
+            } else if (key == "r0") {
+                s.r0 = detail::parse_vec3(val);
+                has_r0 = true;
+            } else if (key == "v0") {
+                s.v0 = detail::parse_vec3(val);
+                has_v0 = true;
+            } else if (key == "t0") {
+                s.t0 = detail::parse_f64(val);
+            } else if (key == "tf") {
+                s.tf = detail::parse_f64(val);
+                has_tf = true;
+            } else if (key == "integrator") {
+                s.integrator = detail::parse_integrator(val);
+            } else if (key == "dt") {
+                s.dt = detail::parse_f64(val);
+            } else if (key == "tol") {
+                s.tol = detail::parse_f64(val);
+            } else if (key == "gravity") {
+                detail::gravity_year(val);
+                s.gravity = val;
+            } else if (key == "degree") {
+                s.degree = detail::parse_int(val);
+            } else if (key == "order") {
+                s.order = detail::parse_int(val);
+                has_order = true;
+            } else if (key == "gravity_tol") {
+                s.gravity_tol = detail::parse_f64(val);
+            } else if (key == "jd0") {
+                s.jd0 = detail::parse_f64(val);
+            } else if (key == "third_body") {
+                for (const std::string &b : detail::words(val)) {
+                    if (b == "sun") {
+                        s.sun = true;
+                    } else if (b == "moon") {
+                        s.moon = true;
+                    } else {
+                        throw std::invalid_argument("unknown body " + b);
+                    }
+                }
+            } else if (key == "output") {
+                s.output = val;
+            } else if (key == "output_every") {
+                s.output_every = detail::parse_int(val);
+            } else {
+                throw err("unknown key " + key);
+            }
+        } catch (const std::logic_error &e) {
+            // invalid_argument / out_of_range from the value parsers
+            throw err("bad value for " + key + " (" + e.what() + ")");
+        }
+    }
+
+    auto err = [&](const std::string &msg) {
+        return std::runtime_error(source + ": " + msg);
+    };
+    if (!has_r0 || !has_v0 || !has_tf) {
+        throw err("r0, v0 and tf are required");
+    }
+    if (!has_order) {
+        s.order = s.degree;
+    }
+    if (s.gravity == "point") {
+        s.degree = s.order = 0;
+    }
+    if (!(s.dt > 0.) || !(s.tf > s.t0)) {
+        throw err("need dt > 0 and tf > t0");
+    }
+    if (s.degree < 0 || s.order < 0 || s.order > s.degree) {
+        throw err("need 0 <= order <= degree");
+    }
+    if (s.output_every < 1) {
+        throw err("output_every must be at least 1");
+    }
+    if (s.output.empty()) {
+        s.output = s.name + ".csv";
+    }
+    return s;
+}
+
+inline Scenario load_scenario(const std::string &path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Cannot open scenario file: " + path);
+    }
+    return parse_scenario(file, path);
+}
+
+// -----------------------------------------------------------------------------
+// Model Cache
+// -----------------------------------------------------------------------------
+// Gravity tables and ephemerides are built once per key and then shared,
+// read-only, by every scenario that asks for them (the policies hold
+// shared_ptrs, so an entry lives as long as any user). Concurrent requests
+// for the same key wait for the one build; different keys build in
+// parallel. Gravity models to degree EmbeddedGravityModel::max_degree come
+// from the embedded tables, higher degrees from <assets>/<model>.txt.
+
+struct GravityKey {
+    std::string model;
+    int degree;
+    int order;
+    auto operator<=>(const GravityKey &) const = default;
+};
+
+class ModelCache {
+  public:
+    explicit ModelCache(std::string assets_dir = "assets")
+        : assets_dir_(std::move(assets_dir)) {};
+
+    std::shared_ptr<const SphericalHarmonicTables>
+    gravity(const std::string &model, int degree, int order) {
+        return get(gravity_, GravityKey{model, degree, order}, [&] {
+            int year = detail::gravity_year(model);
+            if (year == 0) {
+                return std::make_shared<const SphericalHarmonicTables>(
+                    EGMCoefficients(0, 0)
+                );
+            }
+            if (degree <= EmbeddedGravityModel::max_degree) {
+                for (const EmbeddedGravityModel *m : embedded_gravity_models) {
+                    if (m->year == year) {
+                        return std::make_shared<const SphericalHarmonicTables>(
+                            EGMCoefficients(*m, degree, order)
+                        );
+                    }
+                }
+            }
+            EGMCoefficients egm(degree, order);
+            egm.load_egm(assets_dir_ + "/" + model + ".txt", year);
+            return std::make_shared<const SphericalHarmonicTables>(egm);
+        });
+    }
+
+    // Sun/Moon tables over [t0, tf] past jd0, padded a day each side so the
+    // interpolation stencil never runs off the ends of the span
+    std::shared_ptr<const SunMoonEphemeris> ephemeris(f64 jd0, f64 t0, f64 tf) {
+        return get(ephemeris_, std::tuple{jd0, t0, tf}, [&] {
+            return std::make_shared<const SunMoonEphemeris>(
+                jd0, t0 - sec_per_day, tf + sec_per_day
+            );
+        });
+    }
+
+    // Models built so far (cache misses)
+    size_t builds() const {
+        std::lock_guard lock(mutex_);
+        return builds_;
+    }
+
+    // Drop the entries no scenario holds any more
+    void release_unused() {
+        std::lock_guard lock(mutex_);
+        drop_unused(gravity_);
+        drop_unused(ephemeris_);
+    }
+
+  private:
+    template <typename T>
+    using Entry = std::shared_future<std::shared_ptr<const T>>;
+
+    std::string assets_dir_;
+    mutable std::mutex mutex_;
+    std::map<GravityKey, Entry<SphericalHarmonicTables>> gravity_;
+    std::map<std::tuple<f64, f64, f64>, Entry<SunMoonEphemeris>> ephemeris_;
+    size_t builds_ = 0;
+
+    template <typename T, typename Key, typename Make>
+    std::shared_ptr<const T>
+    get(std::map<Key, Entry<T>> &map, const Key &key, Make &&make) {
+        using Ptr = std::shared_ptr<const T>;
+        std::unique_lock lock(mutex_);
+        auto it = map.find(key);
+        if (it != map.end()) {
+            auto entry = it->second;
+            lock.unlock();
+            return entry.get(); // waits while another thread builds it
+        }
+        std::promise<Ptr> promise;
+        map.emplace(key, promise.get_future().share());
+        builds_++;
+        lock.unlock();
+
+        try {
+            Ptr p = make();
+            promise.set_value(p);
+            return p;
+        } catch (...) {
+            // Waiters see the error; the next request retries the build
+            promise.set_exception(std::current_exception());
+            lock.lock();
+            map.erase(key);
+            throw;
+        }
+    }
+
+    template <typename Map> static void drop_unused(Map &map) {
+        for (auto it = map.begin(); it != map.end();) {
+            using namespace std::chrono_literals;
+            auto &f = it->second;
+            bool done = f.wait_for(0s) == std::future_status::ready;
+            bool unused = false;
+            if (done) {
+                try {
+                    unused = f.get().use_count() == 1;
+                } catch (...) {
+                    unused = true;
+                }
+            }
+            it = unused ? map.erase(it) : std::next(it);
+        }
+    }
+};
+
+// -----------------------------------------------------------------------------
+// Batch Runner
+// -----------------------------------------------------------------------------
+
+// Sun and/or Moon point masses sharing one ephemeris
+template <typename State> struct ScenarioThirdBodies {
+    std::vector<ThirdBodyGravityPolicy<State>> bodies;
+
+    template <typename X>
+    vec3t<scalar_t<X>> acceleration(EvalContext<X> &ctx) const {
+        vec3t<scalar_t<X>> a = vec3t<scalar_t<X>>::Zero();
+        for (const auto &b : bodies) {
+            a += b.acceleration(ctx);
+        }
+        return a;
+    }
+};
+
+using ScenarioForces = ForcePolicy3D<
+    vec6,
+    SphericalHarmonicGravityPolicy<vec6>,
+    ScenarioThirdBodies<vec6>>;
+using ScenarioEOM = EOM<vec6, ScenarioForces>;
+
+struct ScenarioResult {
+    std::string name;
+    bool ok = false;
+    std::string error;
+    size_t steps = 0;
+    vec6 xf = vec6::Zero();
+    f64 seconds = 0.; // wall time
+};
+
+// Where a scenario's samples go; one stream per scenario, opened on the
+// worker that runs it
+using ScenarioSink
+    = std::function<std::unique_ptr<std::ostream>(const Scenario &)>;
+
+// CSV files under dir, named by Scenario::output
+inline ScenarioSink file_sink(std::string dir) {
+    return [dir = std::move(dir)](const Scenario &s) {
+        std::filesystem::path p = std::filesystem::path(dir) / s.output;
+        if (p.has_parent_path()) {
+            std::filesystem::create_directories(p.parent_path());
+        }
+        auto os = std::make_unique<std::ofstream>(p);
+        if (!*os) {
+            throw std::runtime_error("Cannot open output file: " + p.string());
+        }
+        return std::unique_ptr<std::ostream>(std::move(os));
+    };
+}
+
+namespace detail {
+template <template <typename, typename> class Policy>
+void integrate_fixed(
+    const ScenarioEOM &f,
+    const Scenario &s,
+    Trajectory<vec6> &traj
+) {
+    FixedStepIntegrator<ScenarioEOM, vec6, Policy> integrator(f, s.dt);
+    integrator.integrate(s.t0, s.tf, s.state(), traj);
+}
+} // namespace detail
+
+// Propagate one scenario with models from the cache and write its samples
+// to the sink (none: no output). The sink is opened only once the
+// propagation succeeded, so a failed scenario leaves no partial file.
+inline ScenarioResult run_scenario(
+    const Scenario &s,
+    ModelCache &cache,
+    const ScenarioSink &sink = nullptr,
+    std::shared_ptr<const SunMoonEphemeris> eph = nullptr
+) {
+    auto start = std::chrono::steady_clock::now();
+    ScenarioResult res;
+    res.name = s.name;
+
+    SphericalHarmonicGravityPolicy<vec6> gravity(
+        s.mu,
+        s.R,
+        cache.gravity(s.gravity, s.degree, s.order),
+        nullptr,
+        s.gravity_tol
+    );
+    ScenarioThirdBodies<vec6> third;
+    if (s.needs_ephemeris()) {
+        if (!eph) {
+            eph = cache.ephemeris(s.jd0, s.t0, s.tf);
+        }
+        if (s.sun) {
+            third.bodies.emplace_back(ThirdBody::SUN, eph);
+        }
+        if (s.moon) {
+            third.bodies.emplace_back(ThirdBody::MOON, eph);
+        }
+    }
+    ScenarioEOM f{ScenarioForces(gravity, third)};
+
+    thread_local Trajectory<vec6> traj; // chunks reused across scenarios
+    switch (s.integrator) {
+    case IntegratorKind::RK1:
+        detail::integrate_fixed<RK1Policy>(f, s, traj);
+        break;
+    case IntegratorKind::RK2:
+        detail::integrate_fixed<RK2Policy>(f, s, traj);
+        break;
+    case IntegratorKind::RK3:
+        detail::integrate_fixed<RK3Policy>(f, s, traj);
+        break;
+    case IntegratorKind::RK4:
+        detail::integrate_fixed<RK4Policy>(f, s, traj);
+        break;
+    case IntegratorKind::RK5:
+        detail::integrate_fixed<RK5Policy>(f, s, traj);
+        break;
+    case IntegratorKind::RK6:
+        detail::integrate_fixed<RK6Policy>(f, s, traj);
+        break;
+    case IntegratorKind::HEUN:
+        detail::integrate_fixed<HeunPolicy>(f, s, traj);
+        break;
+    case IntegratorKind::RALSTON:
+        detail::integrate_fixed<RalstonPolicy>(f, s, traj);
+        break;
+    case IntegratorKind::DP45: {
+        AdaptiveStepIntegrator<vec6, ScenarioEOM, DormandPrince45Policy>
+            integrator(f, s.dt, s.tol);
+        integrator.integrate(s.t0, s.tf, s.state(), traj);
+        break;
+    }
+    }
+
+    if (sink) {
+        std::unique_ptr<std::ostream> os = sink(s);
+        *os << "t_s,x_km,y_km,z_km,vx_kms,vy_kms,vz_kms\n";
+        *os << std::setprecision(17);
+        const size_t n = traj.size();
+        for (size_t i = 0; i < n; i++) {
+            if (i % s.output_every != 0 && i + 1 != n) {
+                continue;
+            }
+            const vec6 &x = traj.states[i];
+            *os << traj.times[i];
+            for (int c = 0; c < 6; c++) {
+                *os << ',' << x(c);
+            }
+            *os << '\n';
+        }
+        os->flush();
+        if (!*os) {
+            throw std::runtime_error("Writing output failed: " + s.output);
+        }
+    }
+
+    res.ok = true;
+    res.steps = traj.size() - 1;
+    res.xf = traj.states.back();
+    res.seconds = std::chrono::duration<f64>(
+                      std::chrono::steady_clock::now() - start
+    )
+                      .count();
+    return res;
+}
+
+// Throws if two scenarios write the same output
+inline void check_outputs(const std::vector<Scenario> &scenarios) {
+    std::map<std::filesystem::path, const Scenario *> seen;
+    for (const Scenario &s : scenarios) {
+        std::filesystem::path p
+            = std::filesystem::path(s.output).lexically_normal();
+        auto [it, fresh] = seen.emplace(p, &s);
+        if (!fresh) {
+            throw std::runtime_error(
+                "Scenarios " + it->second->source + " and " + s.source
+                + " both write " + s.output
+            );
+        }
+    }
+}
+
+// Run every scenario on n_threads workers (0 = all cores). Scenarios that
+// share a jd0 share one ephemeris spanning all of them. A failing scenario
+// is reported in its result and does not stop the others. With a sink, two
+// scenarios writing the same output are an error before anything runs.
+inline std::vector<ScenarioResult> run_scenarios(
+    const std::vector<Scenario> &scenarios,
+    ModelCache &cache,
+    const ScenarioSink &sink = nullptr,
+    int n_threads = 0
+) {
+    if (sink) {
+        check_outputs(scenarios);
+    }
+
+    // Ephemeris span per epoch
+    std::map<f64, std::pair<f64, f64>> spans;
+    for (const Scenario &s : scenarios) {
+        if (!s.needs_ephemeris()) {
+            continue;
+        }
+        auto &span = spans.try_emplace(s.jd0, s.t0, s.tf).first->second;
+        span.first = std::min(span.first, s.t0);
+        span.second = std::max(span.second, s.tf);
+    }
+
+    std::vector<ScenarioResult> results(scenarios.size());
+    parallel_for(
+        static_cast<int>(scenarios.size()),
+        [&](int i) {
+            const Scenario &s = scenarios[i];
+            try {
+                std::shared_ptr<const SunMoonEphemeris> eph;
+                if (s.needs_ephemeris()) {
+                    auto [t0, tf] = spans.at(s.jd0);
+                    eph = cache.ephemeris(s.jd0, t0, tf);
+                }
+                results[i] = run_scenario(s, cache, sink, eph);
+            } catch (const std::exception &e) {
+                results[i].name = s.name;
+                results[i].error = e.what();
+            }
+        },
+        n_threads
+    );
+    return results;
+}
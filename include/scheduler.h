@@ -0,0 +1,209 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "parallel.h"
+#include "registry.h"
+#include "typedefs.h"
+
+// -----------------------------------------------------------------------------
+// Multirate Scheduler
+// -----------------------------------------------------------------------------
+// Periodic tasks (orbit and attitude propagation, sensors, controllers,
+// logging) each fire at their own rate on a common clock. Time is counted in
+// integer ticks (1 us by default) and every period and offset must be a whole
+// number of ticks, so a 100 Hz controller and a 30 s orbit step coincide
+// exactly instead of drifting apart in floating point.
+//
+// When several tasks are due at the same instant they run in dependency
+// levels: a task's level is one more than the highest level among its
+// dependencies. Tasks in one level run concurrently, and the scheduler waits
+// for the whole level before starting the next. Tasks in the same level must
+// not write shared data. Between due instants the scheduler only hops from
+// one fire time to the next.
+
+using TaskId = int;
+
+struct Task {
+    std::string name;
+    i64 period; // ticks
+    i64 next;   // next fire time, ticks
+    std::function<void(f64 t)> fn;
+    std::vector<TaskId> deps;
+    int level = 0;
+    u64 runs = 0;
+};
+
+struct Scheduler {
+    f64 t0;
+    f64 tick;
+    int n_threads;
+    i64 now = 0; // ticks since t0
+    std::vector<Task> tasks;
+
+    explicit Scheduler(f64 t0 = 0., f64 tick = 1e-6, int n_threads = 0)
+        : t0(t0), tick(tick), n_threads(n_threads) {};
+
+    f64 time() const { return t0 + now * tick; }
+
+    // Workers for parallel work inside the task now firing: n >= 0 as for
+    // parallel_for. n < 0 gives 1 while the task shares its level with
+    // others running in parallel, and otherwise every core (n_threads for a
+    // scheduler capped at n_threads > 1).
+    int task_threads(int n) const {
+        if (n >= 0) {
+            return n;
+        }
+        if (n_threads == 1) {
+            return 0;
+        }
+        return level_size_ > 1 ? 1 : n_threads;
+    }
+
+    // Seconds to ticks; throws if s is not a whole number of ticks
+    i64 ticks(f64 s) const {
+        f64 n = std::round(s / tick);
+        if (std::abs(n * tick - s) > 1e-9 * std::max(1., std::abs(s))) {
+            throw std::runtime_error("Time is not a multiple of the tick");
+        }
+        return static_cast<i64>(n);
+    }
+
+    // fn(t) fires at t0 + offset + k * period, k = 0, 1, ... Dependencies
+    // must already be registered, which keeps the graph acyclic.
+    TaskId add(
+        std::string name,
+        f64 period,
+        std::function<void(f64)> fn,
+        std::vector<TaskId> deps = {},
+        f64 offset = 0.
+    ) {
+        i64 p = ticks(period);
+        if (p <= 0) {
+            throw std::runtime_error("Task period must be positive: " + name);
+        }
+        TaskId id = static_cast<TaskId>(tasks.size());
+        int level = 0;
+        for (TaskId d : deps) {
+            if (d < 0 || d >= id) {
+                throw std::runtime_error("Unknown task dependency: " + name);
+            }
+            level = std::max(level, tasks[d].level + 1);
+        }
+        i64 first = ticks(offset);
+        if (first < now) {
+            first += (now - first + p - 1) / p * p;
+        }
+        tasks.push_back(
+            {std::move(name), p, first, std::move(fn), std::move(deps), level}
+        );
+        return id;
+    }
+
+    // Fire every task due in [time(), tf), then set the clock to tf
+    void run_until(f64 tf) {
+        const i64 end = ticks(tf - t0);
+        std::vector<TaskId> due;
+        while (true) {
+            i64 t_next = std::numeric_limits<i64>::max();
+            for (const Task &k : tasks) {
+                t_next = std::min(t_next, k.next);
+            }
+            if (t_next >= end) {
+                break;
+            }
+            now = t_next;
+            f64 t = time();
+
+            due.clear();
+            for (TaskId i = 0; i < static_cast<TaskId>(tasks.size()); i++) {
+                if (tasks[i].next == now) {
+                    due.push_back(i);
+                }
+            }
+            std::stable_sort(due.begin(), due.end(), [&](TaskId a, TaskId b) {
+                return tasks[a].level < tasks[b].level;
+            });
+
+            // One synchronization point per dependency level
+            for (size_t lo = 0; lo < due.size();) {
+                size_t hi = lo;
+                while (hi < due.size()
+                       && tasks[due[hi]].level == tasks[due[lo]].level) {
+                    hi++;
+                }
+                level_size_ = static_cast<int>(hi - lo);
+                parallel_for(
+                    level_size_,
+                    [&](int j) { tasks[due[lo + j]].fn(t); },
+                    n_threads
+                );
+                level_size_ = 0;
+                lo = hi;
+            }
+
+            for (TaskId i : due) {
+                tasks[i].next += tasks[i].period;
+                tasks[i].runs++;
+            }
+        }
+        now = end;
+    }
+
+  private:
+    int level_size_ = 0; // tasks in the level now firing
+};
+
+// -----------------------------------------------------------------------------
+// Registry Tasks
+// -----------------------------------------------------------------------------
+// The step of each task covers [t, t + period), so entity states are held
+// between steps for tasks running at a higher rate. Entities are advanced in
+// parallel inside the task: n_threads as for parallel_for, or by default
+// (n_threads < 0) as many as sched.task_threads() allows when the task
+// fires. The tasks refer to sched, which must not be moved once they are
+// added. The two tasks touch disjoint component arrays, so they may share a
+// level. The task keeps its own copy of the force model, shared by all
+// entities as in translation_step.
+
+template <typename ForcePolicy>
+TaskId add_translation_task(
+    Scheduler &sched,
+    Registry &reg,
+    const ForcePolicy &forces,
+    f64 dt,
+    std::vector<TaskId> deps = {},
+    int n_threads = -1
+) {
+    return sched.add(
+        "translation",
+        dt,
+        [&sched, &reg, forces, dt, n_threads](f64 t) {
+            translation_step(reg, forces, t, dt, sched.task_threads(n_threads));
+        },
+        std::move(deps)
+    );
+}
+
+inline TaskId add_attitude_task(
+    Scheduler &sched,
+    Registry &reg,
+    f64 dt,
+    std::vector<TaskId> deps = {},
+    int n_threads = -1
+) {
+    return sched.add(
+        "attitude",
+        dt,
+        [&sched, &reg, dt, n_threads](f64 t) {
+            attitude_step(reg, t, dt, sched.task_threads(n_threads));
+        },
+        std::move(deps)
+    );
+}
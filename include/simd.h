@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// -----------------------------------------------------------------------------
+// Runtime Dispatched SIMD Kernels
+// -----------------------------------------------------------------------------
+// The hot batch kernels are compiled once per instruction set, each in its
+// own translation unit with its own target flags (src/simd/kernels_*.cpp), so
+// the rest of the binary stays baseline x86-64 and runs on every node. The
+// widest variant the CPU and OS support is picked once, on first use, from
+// CPUID; OADCS_SIMD=baseline|avx2|avx512 in the environment caps it. The
+// baseline variant is SSE2 on x86-64 (part of the ABI) and plain C++
+// elsewhere.
+//
+// Kernels work on structure-of-arrays data: a vector quantity of n elements
+// is its components stored one after the other, component c at p + c * n.
+// The ISA variants are compiled without FMA contraction and use only IEEE
+// exact operations, so every variant returns bit-identical results.
+//
+// This header is included by the kernel translation units and must not pull
+// in inline library code (Eigen etc.): an inline function compiled there
+// with AVX enabled could be the copy the linker keeps for the whole program.
+
+enum class SimdIsa {
+    BASELINE,
+    AVX2,
+    AVX512,
+};
+
+struct SimdKernels {
+    SimdIsa isa;
+    const char *name;
+
+    // Point mass + J2 acceleration, r and a are SoA [x, y, z]
+    void (*gravity_j2)(
+        size_t n,
+        const double *r,
+        double *a,
+        double mu,
+        double J2,
+        double R
+    );
+
+    // out = x + h * k
+    void (*axpy)(
+        size_t n,
+        double h,
+        const double *k,
+        const double *x,
+        double *out
+    );
+
+    // out = x + h / 6 * (k1 + 2 k2 + 2 k3 + k4)
+    void (*rk4_combine)(
+        size_t n,
+        double h,
+        const double *x,
+        const double *k1,
+        const double *k2,
+        const double *k3,
+        const double *k4,
+        double *out
+    );
+
+    // Euler parameters (SoA [q1, q2, q3, q4], scalar last) to DCMs (SoA,
+    // element (i, j) at R + (3 i + j) * n), same convention as ep_to_dcm
+    void (*ep_to_dcm)(size_t n, const double *q, double *R);
+
+    // Euler parameter rates for body rates w (SoA [w1, w2, w3]), as ep_kde
+    void (*ep_kde)(size_t n, const double *q, const double *w, double *dq);
+
+    // Philox4x32-10 of n counters (SoA [c0, c1, c2, c3]) under the key
+    // (k0, k1), out SoA like ctr; same stream as philox4x32 in random.h
+    void (*philox4x32)(
+        size_t n,
+        const uint32_t *ctr,
+        uint32_t *out,
+        uint32_t k0,
+        uint32_t k1
+    );
+};
+
+// Variants built into this binary; null when the compiler could not target
+// the ISA (non-x86 builds)
+const SimdKernels *simd_kernels_baseline();
+const SimdKernels *simd_kernels_avx2();
+const SimdKernels *simd_kernels_avx512();
+
+// Widest ISA supported by this CPU and OS
+SimdIsa simd_detect();
+
+// Kernel table selected at startup (first call), shared by all threads
+const SimdKernels &simd_kernels();
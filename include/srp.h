@@ -0,0 +1,113 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#include "constants.h"
+#include "ephemeris.h"
+#include "eval_context.h"
+#include "typedefs.h"
+
+// -----------------------------------------------------------------------------
+// Solar Radiation Pressure
+// -----------------------------------------------------------------------------
+
+enum class ShadowModel {
+    CONICAL, // exact umbra/penumbra overlap, continuous but kinked at edges
+    SMOOTH,  // tanh blend across the penumbra, smooth for adaptive steps
+};
+
+// Apparent geometry seen from the satellite (Montenbruck & Gill 3.4.2)
+struct ShadowGeometry {
+    f64 a; // apparent radius of the Sun
+    f64 b; // apparent radius of the Earth
+    f64 c; // apparent separation of the centers
+};
+
+inline ShadowGeometry shadow_geometry(const vec3 &r, const vec3 &sun) {
+    vec3 d = sun - r;
+    f64 r_mag = r.norm();
+    f64 d_mag = d.norm();
+    return {
+        std::asin(std::min(r_sun / d_mag, 1.)),
+        std::asin(std::min(r_earth / r_mag, 1.)),
+        std::acos(std::clamp(-r.dot(d) / (r_mag * d_mag), -1., 1.)),
+    };
+}
+
+// Fraction of the solar disk visible, 0 (umbra) to 1 (sunlight)
+inline f64 shadow_conical(const ShadowGeometry &g) {
+    const auto [a, b, c] = g;
+    if (c >= a + b) {
+        return 1.;
+    } else if (c <= b - a) {
+        return 0.;
+    } else if (c <= a - b) {
+        // annular, Earth entirely inside the solar disk
+        return 1. - b * b / (a * a);
+    }
+    f64 x = (c * c + a * a - b * b) / (2. * c);
+    f64 y = std::sqrt(std::max(a * a - x * x, 0.));
+    f64 A = a * a * std::acos(std::clamp(x / a, -1., 1.))
+            + b * b * std::acos(std::clamp((c - x) / b, -1., 1.)) - c * y;
+    return 1. - A / (pi * a * a);
+}
+
+// Smooth approximation, half lit where the Earth's limb crosses the Sun's
+// center. The transition spans about 4 / sharpness penumbra half widths: the
+// default 2.5 keeps it inside the geometric penumbra (under 1% of sunlight at
+// the umbra edge). Sharpness 0.5 spreads it over about twice the penumbra, so
+// adaptive steps cross it without rejections, at the cost of some SRP inside
+// the umbra.
+inline f64 shadow_smooth(const ShadowGeometry &g, f64 sharpness = 2.5) {
+    return 0.5 + 0.5 * std::tanh(sharpness * (g.c - g.b) / g.a);
+}
+
+// Cannonball SRP using the Sun vector from a shared ephemeris cache. The
+// policy holds no per-call state, so one instance may be evaluated for any
+// number of states and threads.
+//
+// With Dual states the shadow function is evaluated on the values, so its
+// partials (nonzero only inside the penumbra) are left out of the Jacobian.
+template <typename State> struct SRPPolicy {
+    f64 k; // p_solar * Cr * A / m, km/s^2 at 1 au
+    ShadowModel model;
+    f64 sharpness;
+    std::shared_ptr<const SunMoonEphemeris> eph;
+
+    explicit SRPPolicy(
+        std::shared_ptr<const SunMoonEphemeris> eph,
+        f64 Cr,
+        f64 area,
+        f64 mass,
+        ShadowModel model = ShadowModel::SMOOTH,
+        f64 sharpness = 2.5
+    )
+        : k(p_solar * Cr * area / mass * 1e-3), model(model),
+          sharpness(sharpness), eph(std::move(eph)) {}
+
+    // Fraction of sunlight at r
+    f64 illumination(const vec3 &r, const vec3 &sun) const {
+        ShadowGeometry g = shadow_geometry(r, sun);
+        return model == ShadowModel::CONICAL ? shadow_conical(g)
+                                             : shadow_smooth(g, sharpness);
+    }
+
+    template <typename X>
+    vec3t<scalar_t<X>> acceleration(EvalContext<X> &ctx) const {
+        using S = scalar_t<X>;
+        vec3t<S> r = ctx.r();
+        const vec3 &sun = ctx.sun(*eph);
+
+        f64 nu = illumination(r.template cast<f64>(), sun);
+        if (nu == 0.) {
+            return vec3t<S>::Zero();
+        }
+
+        vec3t<S> d = sun.template cast<S>() - r;
+        S d_mag = d.norm();
+        vec3t<S> a = S(-nu * k * (au * au)) / (d_mag * d_mag * d_mag) * d;
+        return a;
+    }
+};
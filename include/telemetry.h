@@ -0,0 +1,490 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define OADCS_TELEMETRY_SHM 1
+#endif
+
+#include "registry.h"
+#include "trajectory.h"
+#include "typedefs.h"
+
+// -----------------------------------------------------------------------------
+// Telemetry Ring
+// -----------------------------------------------------------------------------
+// Single producer, multiple consumer ring of fixed size records (source id,
+// time, up to `width` values). The producer never waits: it overwrites the
+// oldest slot, and a consumer that falls more than `capacity` records behind
+// skips ahead and counts what it lost. Each slot is guarded by a sequence
+// number (a seqlock) so a consumer can tell a torn read from a good one.
+//
+// The ring lives either in process memory or in a POSIX shared memory
+// segment (/dev/shm/<name> on Linux) that other processes map read-only;
+// main.py --live is such a reader. Segment layout, version 1, native byte
+// order (little endian on every supported target):
+//
+//   offset  type      field
+//   0       char[8]   magic "OADCSTLM"
+//   8       u32       version (1)
+//   12      u32       width: f64 values per record
+//   16      u64       capacity: slots, a power of two
+//   24      u64       slot_bytes: 24 + 8 * width
+//   32      u64       header_bytes: offset of slot 0 (128)
+//   40      u64       closed: set to 1 when the producer finishes
+//   64      u64       head: records published so far
+//   128     slots     capacity * slot_bytes
+//
+//   slot:   u64 seq, u32 id, u32 n, f64 t, f64 x[width]
+//
+// The segment appears empty and is sized and filled in afterwards; the magic
+// is written last. A reader that finds it too short or without the magic
+// should retry until both are there.
+//
+// Record k goes to slot k % capacity. The producer sets seq to 2k + 1,
+// writes the slot, sets seq to 2k + 2 and then head to k + 1. A consumer
+// reads record k by loading seq, copying the slot and loading seq again; the
+// copy is good if both loads saw 2k + 2. A larger seq means the slot was
+// already reused and the consumer has been lapped.
+
+static_assert(std::atomic<u64>::is_always_lock_free);
+
+struct TelemetryHeader {
+    char magic[8];
+    u32 version;
+    u32 width;
+    u64 capacity;
+    u64 slot_bytes;
+    u64 header_bytes;
+    std::atomic<u64> closed;
+    alignas(64) std::atomic<u64> head;
+};
+static_assert(sizeof(TelemetryHeader) == 128);
+
+struct TelemetrySlot {
+    std::atomic<u64> seq;
+    u32 id;
+    u32 n;
+    f64 t;
+    // f64 x[width] follows
+};
+static_assert(sizeof(TelemetrySlot) == 24);
+
+inline constexpr char telemetry_magic[8] = {
+    'O', 'A', 'D', 'C', 'S', 'T', 'L', 'M'
+};
+inline constexpr u32 telemetry_version = 1;
+
+namespace detail {
+inline size_t telemetry_bytes(size_t capacity, u32 width) {
+    return sizeof(TelemetryHeader) + capacity * (24 + 8 * size_t(width));
+}
+} // namespace detail
+
+// Producer side. Owns the memory (and the segment name, unlinked on
+// destruction).
+class TelemetryRing {
+  public:
+    // In process ring
+    TelemetryRing(size_t capacity, u32 width) {
+        check(capacity, width);
+        bytes_ = detail::telemetry_bytes(capacity, width);
+        base_ = static_cast<std::byte *>(std::aligned_alloc(64, round64()));
+        if (!base_) {
+            throw std::bad_alloc();
+        }
+        init(capacity, width);
+    }
+
+#ifdef OADCS_TELEMETRY_SHM
+    // Ring in a new shared memory segment; name as for shm_open ("/oadcs").
+    // Fails if the name is taken, which may be another live run; replace
+    // unlinks the existing segment first (e.g. left by a crashed run).
+    static TelemetryRing shared(
+        const std::string &name,
+        size_t capacity,
+        u32 width,
+        bool replace = false
+    ) {
+        check(capacity, width);
+        TelemetryRing ring;
+        ring.bytes_ = detail::telemetry_bytes(capacity, width);
+        if (replace) {
+            shm_unlink(name.c_str());
+        }
+        int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0) {
+            throw std::runtime_error(
+                errno == EEXIST
+                    ? "Telemetry segment " + name
+                          + " is in use (remove it if it is stale)"
+                    : "Cannot create telemetry segment " + name
+            );
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0) {
+            ring.dev_ = st.st_dev;
+            ring.ino_ = st.st_ino;
+        }
+        ring.name_ = name;
+        bool ok = ftruncate(fd, static_cast<off_t>(ring.bytes_)) == 0;
+        void *p = ok ? mmap(
+                           nullptr,
+                           ring.bytes_,
+                           PROT_READ | PROT_WRITE,
+                           MAP_SHARED,
+                           fd,
+                           0
+                       )
+                     : MAP_FAILED;
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            shm_unlink(name.c_str());
+            throw std::runtime_error("Cannot map telemetry segment " + name);
+        }
+        ring.base_ = static_cast<std::byte *>(p);
+        ring.init(capacity, width);
+        return ring;
+    }
+#endif
+
+    TelemetryRing(const TelemetryRing &) = delete;
+    TelemetryRing &operator=(const TelemetryRing &) = delete;
+    TelemetryRing(TelemetryRing &&o) noexcept
+        : base_(std::exchange(o.base_, nullptr)), bytes_(o.bytes_),
+          name_(std::move(o.name_)), dev_(o.dev_), ino_(o.ino_),
+          next_(o.next_) {};
+
+    ~TelemetryRing() {
+        if (!base_) {
+            return;
+        }
+        header().closed.store(1, std::memory_order_release);
+#ifdef OADCS_TELEMETRY_SHM
+        if (!name_.empty()) {
+            munmap(base_, bytes_);
+            if (owns_name()) {
+                shm_unlink(name_.c_str());
+            }
+            return;
+        }
+#endif
+        std::free(base_);
+    }
+
+    u32 width() const { return header().width; }
+    size_t capacity() const { return header().capacity; }
+    u64 published() const { return next_; }
+    const std::byte *data() const { return base_; }
+
+    // Publish one record; values past width are dropped. Never blocks.
+    void publish(u32 id, f64 t, const f64 *x, size_t n) {
+        TelemetryHeader &h = header();
+        const u64 k = next_++;
+        TelemetrySlot &s = slot(base_, h, k);
+        s.seq.store(2 * k + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        n = std::min<size_t>(n, h.width);
+        s.id = id;
+        s.n = static_cast<u32>(n);
+        s.t = t;
+        std::memcpy(values(s), x, n * sizeof(f64));
+        s.seq.store(2 * k + 2, std::memory_order_release);
+        h.head.store(k + 1, std::memory_order_release);
+    }
+
+    // Any Eigen vector of f64
+    template <typename V> void publish(u32 id, f64 t, const V &x) {
+        publish(id, t, x.data(), static_cast<size_t>(x.size()));
+    }
+
+    // Mark the run finished; readers see closed once they have caught up
+    void close() { header().closed.store(1, std::memory_order_release); }
+
+    static TelemetrySlot &
+    slot(std::byte *base, const TelemetryHeader &h, u64 k) {
+        size_t i = static_cast<size_t>(k & (h.capacity - 1));
+        return *reinterpret_cast<TelemetrySlot *>(
+            base + h.header_bytes + i * h.slot_bytes
+        );
+    }
+    static f64 *values(TelemetrySlot &s) {
+        return reinterpret_cast<f64 *>(&s + 1);
+    }
+
+  private:
+    std::byte *base_ = nullptr;
+    size_t bytes_ = 0;
+    std::string name_;
+    u64 dev_ = 0, ino_ = 0; // identity of the shared segment
+    u64 next_ = 0;
+
+    TelemetryRing() = default;
+
+#ifdef OADCS_TELEMETRY_SHM
+    // Whether name_ still refers to this ring's segment, not to one that
+    // replaced it
+    bool owns_name() const {
+        int fd = shm_open(name_.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        bool same = fstat(fd, &st) == 0 && u64(st.st_dev) == dev_
+                    && u64(st.st_ino) == ino_;
+        ::close(fd);
+        return same;
+    }
+#endif
+
+    TelemetryHeader &header() const {
+        return *reinterpret_cast<TelemetryHeader *>(base_);
+    }
+    size_t round64() const { return (bytes_ + 63) / 64 * 64; }
+
+    static void check(size_t capacity, u32 width) {
+        if (capacity == 0 || (capacity & (capacity - 1)) != 0 || width == 0) {
+            throw std::runtime_error(
+                "Telemetry capacity must be a power of two and width > 0"
+            );
+        }
+    }
+
+    // The magic goes in last, so a reader that sees it sees a complete
+    // header
+    void init(size_t capacity, u32 width) {
+        std::memset(base_, 0, bytes_);
+        TelemetryHeader *h = new (base_) TelemetryHeader{};
+        h->version = telemetry_version;
+        h->width = width;
+        h->capacity = capacity;
+        h->slot_bytes = 24 + 8 * size_t(width);
+        h->header_bytes = sizeof(TelemetryHeader);
+        for (u64 k = 0; k < capacity; k++) {
+            new (&slot(base_, *h, k)) TelemetrySlot{};
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(h->magic, telemetry_magic, 8);
+    }
+};
+
+struct TelemetryRecord {
+    u32 id = 0;
+    f64 t = 0.;
+    std::vector<f64> x;
+};
+
+// Consumer side. Any number of readers may follow one ring, each with its
+// own cursor; readers never write to the ring.
+class TelemetryReader {
+  public:
+    // Follow an in process ring, from the oldest record still held
+    explicit TelemetryReader(const TelemetryRing &ring)
+        : base_(const_cast<std::byte *>(ring.data())) {
+        validate();
+        cursor_ = oldest();
+    }
+
+#ifdef OADCS_TELEMETRY_SHM
+    // Attach to a shared memory segment created by TelemetryRing::shared
+    static TelemetryReader attach(const std::string &name) {
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            throw std::runtime_error("No telemetry segment " + name);
+        }
+        struct stat st;
+        void *p = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && st.st_size >= 128) {
+            p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            throw std::runtime_error("Cannot map telemetry segment " + name);
+        }
+        TelemetryReader r(static_cast<std::byte *>(p), st.st_size);
+        r.validate();
+        r.cursor_ = r.oldest();
+        return r;
+    }
+#endif
+
+    TelemetryReader(const TelemetryReader &) = delete;
+    TelemetryReader &operator=(const TelemetryReader &) = delete;
+    TelemetryReader(TelemetryReader &&o) noexcept
+        : base_(std::exchange(o.base_, nullptr)),
+          mapped_(std::exchange(o.mapped_, 0)), cursor_(o.cursor_),
+          dropped_(o.dropped_) {};
+
+    ~TelemetryReader() {
+#ifdef OADCS_TELEMETRY_SHM
+        if (base_ && mapped_) {
+            munmap(base_, mapped_);
+        }
+#endif
+    }
+
+    // Records lost to overwrites so far
+    u64 dropped() const { return dropped_; }
+
+    // True once the producer closed the ring and every record was read
+    bool finished() const {
+        return header().closed.load(std::memory_order_acquire)
+               && cursor_ == header().head.load(std::memory_order_acquire);
+    }
+
+    // Next record, if one is available. Never blocks.
+    bool next(TelemetryRecord &r) {
+        const TelemetryHeader &h = header();
+        while (true) {
+            u64 head = h.head.load(std::memory_order_acquire);
+            if (cursor_ >= head) {
+                return false;
+            }
+            if (head - cursor_ > h.capacity) {
+                dropped_ += head - h.capacity - cursor_;
+                cursor_ = head - h.capacity;
+            }
+            TelemetrySlot &s = TelemetryRing::slot(base_, h, cursor_);
+            const u64 want = 2 * cursor_ + 2;
+            u64 s1 = s.seq.load(std::memory_order_acquire);
+            if (s1 == want) {
+                r.id = s.id;
+                r.t = s.t;
+                r.x.resize(std::min<u32>(s.n, h.width));
+                std::memcpy(
+                    r.x.data(),
+                    TelemetryRing::values(s),
+                    r.x.size() * sizeof(f64)
+                );
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (s.seq.load(std::memory_order_relaxed) == want) {
+                    cursor_++;
+                    return true;
+                }
+            }
+            // Lapped while reading: skip the lost record and retry
+            dropped_++;
+            cursor_++;
+        }
+    }
+
+    // Drain everything currently available into out (appended)
+    size_t poll(std::vector<TelemetryRecord> &out) {
+        size_t n = 0;
+        TelemetryRecord r;
+        while (next(r)) {
+            out.push_back(r);
+            n++;
+        }
+        return n;
+    }
+
+  private:
+    std::byte *base_ = nullptr;
+    size_t mapped_ = 0; // bytes mapped by attach, 0 for in process rings
+    u64 cursor_ = 0;
+    u64 dropped_ = 0;
+
+    TelemetryReader(std::byte *base, size_t mapped)
+        : base_(base), mapped_(mapped) {};
+
+    const TelemetryHeader &header() const {
+        return *reinterpret_cast<const TelemetryHeader *>(base_);
+    }
+
+    u64 oldest() const {
+        u64 head = header().head.load(std::memory_order_acquire);
+        return head > header().capacity ? head - header().capacity : 0;
+    }
+
+    void validate() const {
+        const TelemetryHeader &h = header();
+        if (std::memcmp(h.magic, telemetry_magic, 8) != 0
+            || h.version != telemetry_version
+            || (mapped_
+                && mapped_ < detail::telemetry_bytes(h.capacity, h.width))) {
+            throw std::runtime_error(
+                "Not a telemetry segment (or wrong version)"
+            );
+        }
+    }
+};
+
+// -----------------------------------------------------------------------------
+// Publishers
+// -----------------------------------------------------------------------------
+
+// Sequence adapters for integrate(): samples go to the wrapped sequences as
+// before and each state is also published under id with the time pushed
+// just before it.
+//
+//   TelemetryTap tap(ring, 0, times, states);
+//   rk4.integrate(t0, tf, x0, tap.times, tap.states);
+template <typename TimeSeq, typename StateSeq> struct TelemetryTap {
+    struct Times {
+        using value_type = f64;
+        TelemetryTap *tap;
+        void clear() { tap->times_.clear(); }
+        void reserve(size_t n) { reserve_samples(tap->times_, n); }
+        void push_back(f64 t) {
+            tap->t_ = t;
+            tap->times_.push_back(t);
+        }
+    };
+    struct States {
+        using value_type = typename StateSeq::value_type;
+        TelemetryTap *tap;
+        void clear() { tap->states_.clear(); }
+        void reserve(size_t n) { reserve_samples(tap->states_, n); }
+        void push_back(const value_type &x) {
+            tap->states_.push_back(x);
+            tap->ring_.publish(tap->id_, tap->t_, x);
+        }
+    };
+
+    Times times{this};
+    States states{this};
+
+    TelemetryTap(
+        TelemetryRing &ring,
+        u32 id,
+        TimeSeq &times_out,
+        StateSeq &states_out
+    )
+        : ring_(ring), id_(id), times_(times_out), states_(states_out) {};
+    TelemetryTap(const TelemetryTap &) = delete;
+    TelemetryTap &operator=(const TelemetryTap &) = delete;
+
+  private:
+    TelemetryRing &ring_;
+    u32 id_;
+    TimeSeq &times_;
+    StateSeq &states_;
+    f64 t_ = 0.;
+};
+
+// Registry observer, the live counterpart of write_states: one record per
+// output entity, id = entity, x = [r, v, q, w] truncated to the ring width
+inline void publish_states(const Registry &reg, f64 t, TelemetryRing &ring) {
+    f64 x[13];
+    for (Entity e : reg.output) {
+        std::memcpy(x, reg.pos[e].data(), 3 * sizeof(f64));
+        std::memcpy(x + 3, reg.vel[e].data(), 3 * sizeof(f64));
+        std::memcpy(x + 6, reg.ep[e].data(), 4 * sizeof(f64));
+        std::memcpy(x + 10, reg.omega[e].data(), 3 * sizeof(f64));
+        ring.publish(e, t, x, 13);
+    }
+}
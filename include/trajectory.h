@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "typedefs.h"
+
+// -----------------------------------------------------------------------------
+// Trajectory Storage
+// -----------------------------------------------------------------------------
+// ChunkedSeq is an append-only sequence stored in fixed-size chunks drawn from
+// a std::pmr memory resource. Growing never moves existing elements, and
+// clear() keeps the chunks, so a worker that reuses one Trajectory (or one
+// TrajectoryArena) across Monte Carlo cases stops touching the heap once the
+// longest case has been seen.
+
+template <typename T> struct ChunkedSeq {
+    using value_type = T;
+
+    std::pmr::polymorphic_allocator<T> alloc;
+    std::pmr::vector<T *> chunks;
+    size_t chunk;
+    size_t n = 0;
+
+    explicit ChunkedSeq(
+        std::pmr::memory_resource *mr = std::pmr::get_default_resource(),
+        size_t chunk = 1024
+    )
+        : alloc(mr), chunks(mr), chunk(chunk) {};
+
+    ChunkedSeq(const ChunkedSeq &) = delete;
+    ChunkedSeq &operator=(const ChunkedSeq &) = delete;
+    ChunkedSeq(ChunkedSeq &&other) noexcept
+        : alloc(other.alloc), chunks(std::move(other.chunks)),
+          chunk(other.chunk), n(std::exchange(other.n, 0)) {};
+
+    ~ChunkedSeq() {
+        clear();
+        for (T *c : chunks) {
+            alloc.deallocate(c, chunk);
+        }
+    }
+
+    size_t size() const { return n; }
+    bool empty() const { return n == 0; }
+    size_t capacity() const { return chunks.size() * chunk; }
+
+    // Allocate chunks up front for at least m elements
+    void reserve(size_t m) {
+        while (capacity() < m) {
+            chunks.push_back(alloc.allocate(chunk));
+        }
+    }
+
+    void push_back(const T &v) {
+        if (n == capacity()) {
+            chunks.push_back(alloc.allocate(chunk));
+        }
+        ::new (static_cast<void *>(&(*this)[n])) T(v);
+        n++;
+    }
+
+    // Destroys the elements, keeps the chunks
+    void clear() {
+        for (size_t i = 0; i < n; i++) {
+            (*this)[i].~T();
+        }
+        n = 0;
+    }
+
+    T &operator[](size_t i) { return chunks[i / chunk][i % chunk]; }
+    const T &operator[](size_t i) const { return chunks[i / chunk][i % chunk]; }
+    T &front() { return (*this)[0]; }
+    const T &front() const { return (*this)[0]; }
+    T &back() { return (*this)[n - 1]; }
+    const T &back() const { return (*this)[n - 1]; }
+
+    // Minimal forward iteration for range-for
+    template <typename Seq, typename Ref> struct Iter {
+        Seq *seq;
+        size_t i;
+        Ref operator*() const { return (*seq)[i]; }
+        Iter &operator++() {
+            i++;
+            return *this;
+        }
+        bool operator!=(const Iter &o) const { return i != o.i; }
+    };
+    Iter<ChunkedSeq, T &> begin() { return {this, 0}; }
+    Iter<ChunkedSeq, T &> end() { return {this, n}; }
+    Iter<const ChunkedSeq, const T &> begin() const { return {this, 0}; }
+    Iter<const ChunkedSeq, const T &> end() const { return {this, n}; }
+};
+
+// Times and states of one propagation, passed to integrate() in place of the
+// two std::vectors
+template <typename State> struct Trajectory {
+    ChunkedSeq<f64> times;
+    ChunkedSeq<State> states;
+
+    explicit Trajectory(
+        std::pmr::memory_resource *mr = std::pmr::get_default_resource(),
+        size_t chunk = 1024
+    )
+        : times(mr, chunk), states(mr, chunk) {};
+
+    size_t size() const { return times.size(); }
+    void clear() {
+        times.clear();
+        states.clear();
+    }
+    void reserve(size_t m) {
+        times.reserve(m);
+        states.reserve(m);
+    }
+};
+
+// One upfront buffer per worker with monotonic allocation; overflow falls
+// back to the upstream resource. release() recycles the whole buffer and may
+// only be called once every Trajectory built on it has been destroyed.
+struct TrajectoryArena {
+    std::vector<std::byte> buffer;
+    std::pmr::monotonic_buffer_resource pool;
+
+    explicit TrajectoryArena(
+        size_t bytes,
+        std::pmr::memory_resource *upstream = std::pmr::get_default_resource()
+    )
+        : buffer(bytes), pool(buffer.data(), buffer.size(), upstream) {};
+
+    std::pmr::memory_resource *resource() { return &pool; }
+    void release() { pool.release(); }
+};
+
+// Reserve storage for n samples where the sequence supports it
+template <typename Seq> void reserve_samples(Seq &seq, size_t n) {
+    if constexpr (requires { seq.reserve(n); }) {
+        seq.reserve(n);
+    }
+}
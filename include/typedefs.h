@@ -35,6 +35,7 @@ using vec9 = eig::Vector<f64, 9>;
 using vec10 = eig::Vector<f64, 10>;
 using vec11 = eig::Vector<f64, 11>;
 using vec12 = eig::Vector<f64, 12>;
+using vec42 = eig::Vector<f64, 42>; // state + 6x6 STM
 using vecx = eig::VectorXd;
 // Matrices
 using mat2 = eig::Matrix2d;
@@ -52,3 +53,17 @@ using matx = eig::Matrix<f64, eig::Dynamic, eig::Dynamic>;
 // Quaternions
 using quate = eig::Quaterniond;
 
+// Scalar generic
+template <typename T> using vec3t = eig::Matrix<T, 3, 1>;
+template <typename T> using vec4t = eig::Matrix<T, 4, 1>;
+template <typename T> using vec6t = eig::Matrix<T, 6, 1>;
+template <typename T> using mat3t = eig::Matrix<T, 3, 3>;
+template <typename T> using mat4t = eig::Matrix<T, 4, 4>;
+using vec3f = vec3t<f32>;
+using vec4f = vec4t<f32>;
+using vec6f = vec6t<f32>;
+using mat3f = mat3t<f32>;
+
+// Scalar type of an Eigen state
+template <typename State> using scalar_t = typename State::Scalar;
+
@@ -1,4 +1,6 @@
 #pragma once
+#include <type_traits>
+
 #include "constants.h"
 // #include "typedefs.h"
 // #include <iostream>
@@ -37,38 +39,138 @@ enum class UnitsMass {
     METRIC_TON,
 };
 
+// Radians per unit, indexed by UnitsAngle
+constexpr f64 angle_to_rad[] = {
+    1.,              // RADIANS
+    deg2rad,         // DEGREES
+    deg2rad / 3600., // ARCSEC
+    deg2rad / 60.,   // MINUTES
+};
+
+// Runtime conversion, one table lookup per side (prefer the typed quantities
+// below where units are known at compile time)
 template <class T>
 auto convertAngle(T val, UnitsAngle units_in, UnitsAngle units_out) -> T {
-    using enum UnitsAngle;
-    // convert to radians
-    switch (units_in) {
-    case RADIANS:
-        break;
-    case DEGREES:
-        val *= deg2rad;
-        break;
-    case MINUTES:
-        val *= deg2rad / 60.;
-        break;
-    case ARCSEC:
-        val *= deg2rad / 3600.;
-        break;
+    if (units_in == units_out) {
+        return val;
     }
+    return val
+           * (angle_to_rad[static_cast<int>(units_in)]
+              / angle_to_rad[static_cast<int>(units_out)]);
+}
+
+// -----------------------------------------------------------------------------
+// Compile-Time Quantities
+// -----------------------------------------------------------------------------
+// Quantity<Dim, Scale, Rep> stores value in a unit that is Scale times the
+// project base unit (km, kg, s, rad). Converting between units of the same
+// dimension multiplies by a ratio of template constants, so it folds to one
+// constant multiply (or nothing when the units agree). Mixing dimensions has
+// no conversion and fails to compile. Rep can be an Eigen vector, e.g. a
+// triple of Euler angles or a position.
+
+// Dimension exponents: length, mass, time, angle
+template <int L, int M, int T, int A> struct Dim {};
+
+using DimLength = Dim<1, 0, 0, 0>;
+using DimMass = Dim<0, 1, 0, 0>;
+using DimTime = Dim<0, 0, 1, 0>;
+using DimAngle = Dim<0, 0, 0, 1>;
+using DimGravParam = Dim<3, 0, -2, 0>; // mu
+
+template <typename D1, typename D2> struct DimMul;
+template <int L1, int M1, int T1, int A1, int L2, int M2, int T2, int A2>
+struct DimMul<Dim<L1, M1, T1, A1>, Dim<L2, M2, T2, A2>> {
+    using type = Dim<L1 + L2, M1 + M2, T1 + T2, A1 + A2>;
+};
+template <typename D1, typename D2> struct DimDiv;
+template <int L1, int M1, int T1, int A1, int L2, int M2, int T2, int A2>
+struct DimDiv<Dim<L1, M1, T1, A1>, Dim<L2, M2, T2, A2>> {
+    using type = Dim<L1 - L2, M1 - M2, T1 - T2, A1 - A2>;
+};
+
+template <typename D, f64 Scale = 1., typename Rep = f64> struct Quantity {
+    using dim = D;
+    static constexpr f64 scale = Scale;
+    Rep value;
+
+    constexpr Quantity() = default;
+    constexpr explicit Quantity(const Rep &v) : value(v) {};
+
+    // Same dimension, other unit
+    template <f64 S2>
+    constexpr Quantity(const Quantity<D, S2, Rep> &q)
+        : value(q.value * (S2 / Scale)) {};
 
-    // convert to output
-    switch (units_out) {
-    case RADIANS:
-        break;
-    case DEGREES:
-        val *= rad2deg;
-        break;
-    case MINUTES:
-        val *= rad2deg * 60.;
-        break;
-    case ARCSEC:
-        val *= rad2deg * 3600.;
-        break;
+    // Value expressed in another unit of the same dimension
+    template <typename U> constexpr Rep in() const {
+        static_assert(std::is_same_v<typename U::dim, D>, "dimension mismatch");
+        return value * (Scale / U::scale);
     }
 
-    return val;
-}
\ No newline at end of file
+    constexpr Quantity operator+(const Quantity &q) const {
+        return Quantity(value + q.value);
+    }
+    constexpr Quantity operator-(const Quantity &q) const {
+        return Quantity(value - q.value);
+    }
+    constexpr Quantity operator-() const { return Quantity(-value); }
+    constexpr Quantity operator*(f64 k) const { return Quantity(value * k); }
+    constexpr Quantity operator/(f64 k) const { return Quantity(value / k); }
+};
+
+template <typename D, f64 S, typename Rep>
+constexpr Quantity<D, S, Rep> operator*(f64 k, const Quantity<D, S, Rep> &q) {
+    return q * k;
+}
+
+template <typename D1, f64 S1, typename D2, f64 S2>
+constexpr auto operator*(const Quantity<D1, S1> &a, const Quantity<D2, S2> &b) {
+    return Quantity<typename DimMul<D1, D2>::type, S1 * S2>(a.value * b.value);
+}
+template <typename D1, f64 S1, typename D2, f64 S2>
+constexpr auto operator/(const Quantity<D1, S1> &a, const Quantity<D2, S2> &b) {
+    return Quantity<typename DimDiv<D1, D2>::type, S1 / S2>(a.value / b.value);
+}
+
+// Units (scale relative to km, kg, s, rad)
+using Radians = Quantity<DimAngle, 1.>;
+using Degrees = Quantity<DimAngle, deg2rad>;
+using ArcMinutes = Quantity<DimAngle, deg2rad / 60.>;
+using ArcSeconds = Quantity<DimAngle, deg2rad / 3600.>;
+using Radians3 = Quantity<DimAngle, 1., vec3>;
+using Degrees3 = Quantity<DimAngle, deg2rad, vec3>;
+
+using Millimeters = Quantity<DimLength, 1e-6>;
+using Centimeters = Quantity<DimLength, 1e-5>;
+using Meters = Quantity<DimLength, 1e-3>;
+using Kilometers = Quantity<DimLength, 1.>;
+using Feet = Quantity<DimLength, 3.048e-4>;
+using Inches = Quantity<DimLength, 2.54e-5>;
+using AstronomicalUnits = Quantity<DimLength, 149597870.7>;
+
+using Micrograms = Quantity<DimMass, 1e-9>;
+using Milligrams = Quantity<DimMass, 1e-6>;
+using Grams = Quantity<DimMass, 1e-3>;
+using Kilograms = Quantity<DimMass, 1.>;
+using MetricTons = Quantity<DimMass, 1e3>;
+
+using Seconds = Quantity<DimTime, 1.>;
+using Minutes = Quantity<DimTime, 60.>;
+using Hours = Quantity<DimTime, 3600.>;
+using Days = Quantity<DimTime, 86400.>;
+using JulianYears = Quantity<DimTime, 365.25 * 86400.>;
+
+using GravParam = Quantity<DimGravParam, 1.>;     // km^3/s^2
+using GravParamSI = Quantity<DimGravParam, 1e-9>; // m^3/s^2
+
+// Literals, e.g. 45._deg, 7000._km, 3._m
+constexpr Radians operator""_rad(long double v) { return Radians(v); }
+constexpr Degrees operator""_deg(long double v) { return Degrees(v); }
+constexpr ArcSeconds operator""_arcsec(long double v) {
+    return ArcSeconds(v);
+}
+constexpr Meters operator""_m(long double v) { return Meters(v); }
+constexpr Kilometers operator""_km(long double v) { return Kilometers(v); }
+constexpr Kilograms operator""_kg(long double v) { return Kilograms(v); }
+constexpr Seconds operator""_s(long double v) { return Seconds(v); }
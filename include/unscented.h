@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "typedefs.h"
+
+// -----------------------------------------------------------------------------
+// Unscented Transform Covariance Propagation
+// -----------------------------------------------------------------------------
+// The 2n + 1 = 13 sigma points of a vec6 mean and covariance are stored as the
+// columns of one 6x13 matrix, which is itself the integrator state: a single
+// FixedStepIntegrator/AdaptiveStepIntegrator run over SigmaPointEOM advances
+// all points at once, the stage arithmetic is one vectorized matrix
+// expression and the adaptive controller picks one step sequence for the
+// whole set. Mean and covariance are rebuilt at the requested epochs.
+//
+// Scaled UT (Julier 2002, Wan & van der Merwe 2000): lambda = alpha^2 (n +
+// kappa) - n, sigma points m +- sqrt(n + lambda) * columns of chol(P).
+
+using SigmaPoints6 = eig::Matrix<f64, 6, 13>;
+
+struct UTConfig {
+    f64 alpha = 1.; // spread of the points
+    f64 beta = 2.;  // prior knowledge of the distribution (2 = Gaussian)
+    f64 kappa = 0.; // secondary scaling
+};
+
+struct UTWeights {
+    f64 gamma; // sqrt(n + lambda)
+    f64 wm0;   // mean weight of the center point
+    f64 wc0;   // covariance weight of the center point
+    f64 wi;    // weight of every other point
+};
+
+inline UTWeights ut_weights(const UTConfig &cfg) {
+    const f64 n = 6.;
+    f64 lambda = cfg.alpha * cfg.alpha * (n + cfg.kappa) - n;
+    f64 wm0 = lambda / (n + lambda);
+    return {
+        std::sqrt(n + lambda),
+        wm0,
+        wm0 + 1. - cfg.alpha * cfg.alpha + cfg.beta,
+        0.5 / (n + lambda),
+    };
+}
+
+inline SigmaPoints6
+sigma_points(const vec6 &m, const mat6 &P, const UTConfig &cfg = {}) {
+    eig::LLT<mat6> llt(P);
+    if (llt.info() != eig::Success) {
+        throw std::runtime_error("Covariance is not positive definite");
+    }
+    mat6 S = ut_weights(cfg).gamma * llt.matrixL().toDenseMatrix();
+
+    SigmaPoints6 X;
+    X.col(0) = m;
+    X.middleCols<6>(1) = S.colwise() + m;
+    X.middleCols<6>(7) = (-S).colwise() + m;
+    return X;
+}
+
+inline std::pair<vec6, mat6>
+sigma_mean_cov(const SigmaPoints6 &X, const UTConfig &cfg = {}) {
+    UTWeights w = ut_weights(cfg);
+    vec6 m = w.wm0 * X.col(0) + w.wi * X.rightCols<12>().rowwise().sum();
+
+    SigmaPoints6 D = X.colwise() - m;
+    mat6 P = w.wc0 * D.col(0) * D.col(0).transpose()
+             + w.wi * D.rightCols<12>() * D.rightCols<12>().transpose();
+    return {m, P};
+}
+
+// EOM of the 13 sigma points; column j is [r, v] of point j. Every column
+// goes through the one force model, so its policies must not carry state
+// from one acceleration call to the next (none in this library do).
+template <typename ForcePolicy> struct SigmaPointEOM {
+    ForcePolicy forces;
+
+    explicit SigmaPointEOM(const ForcePolicy &fp) : forces(fp) {};
+
+    SigmaPoints6 operator()(f64 t, const SigmaPoints6 &X) const {
+        SigmaPoints6 dXdt;
+        dXdt.topRows<3>() = X.bottomRows<3>();
+        for (int j = 0; j < 13; j++) {
+            vec6 x = X.col(j);
+            dXdt.col(j).tail<3>() = forces.acceleration(t, x);
+        }
+        return dXdt;
+    }
+};
+
+struct UTEstimate {
+    f64 t;
+    vec6 mean;
+    mat6 cov;
+};
+
+// Mean and covariance at each epoch (ascending, >= t0). Integrator is a
+// Fixed/AdaptiveStepIntegrator over SigmaPoints6 with a SigmaPointEOM.
+template <typename Integrator>
+std::vector<UTEstimate> unscented_propagate(
+    const Integrator &integ,
+    f64 t0,
+    const vec6 &m0,
+    const mat6 &P0,
+    const std::vector<f64> &epochs,
+    const UTConfig &cfg = {}
+) {
+    Integrator local = integ;
+    SigmaPoints6 X = sigma_points(m0, P0, cfg);
+    f64 t = t0;
+
+    std::vector<f64> times;
+    std::vector<SigmaPoints6> states;
+    std::vector<UTEstimate> out;
+    out.reserve(epochs.size());
+    for (f64 te : epochs) {
+        local.integrate(t, te, X, times, states);
+        X = states.back();
+        t = te;
+        auto [m, P] = sigma_mean_cov(X, cfg);
+        out.push_back({te, m, P});
+    }
+    return out;
+}
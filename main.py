@@ -1,38 +1,166 @@
-import plotly.graph_objects as go
+import argparse
+import mmap
+import os
+import time
+
 import numpy as np
 
-# Load orbit data
-data = np.loadtxt("build/orbit.csv", delimiter=",", skiprows=1)
-x, y, z = data[:, 1], data[:, 2], data[:, 3]
-
-fig = go.Figure(layout=go.Layout(title=go.layout.Title(text="test")))
-
-# Earth sphere
-N = 200
-R = 6371.0
-u = np.linspace(-np.pi, np.pi, N)
-v = np.linspace(0, np.pi, N)
-U, V = np.meshgrid(u, v)
-X = R * np.sin(V) * np.cos(U)
-Y = R * np.sin(V) * np.sin(U)
-Z = R * np.cos(V)
-
-# Plot orbit
-fig.add_scatter3d(
-    x=x, y=y, z=z, mode="lines", line=dict(color="red", width=4), name="Orbit"
-)
-
-# Plot sphere surface
-fig.add_surface(x=X, y=Y, z=Z, colorscale="blues", opacity=0.75)
-
-fig.update_layout(
-    scene=dict(
-        aspectmode="data",
-        xaxis_title="X (km)",
-        yaxis_title="Y (km)",
-        zaxis_title="Z (km)",
-    ),
-    title="Satellite Orbit around Earth",
-)
-
-fig.show()
+# Telemetry segment layout, see include/telemetry.h
+TELEMETRY_MAGIC = b"OADCSTLM"
+TELEMETRY_VERSION = 1
+TELEMETRY_HEADER_BYTES = 128
+HEAD_OFFSET = 64
+
+
+class TelemetryNotReady(Exception):
+    """The segment exists but its producer has not finished setting it up."""
+
+
+class TelemetryReader:
+    """Follows a TelemetryRing shared memory segment without blocking the
+    producer. Records lost to overwrites are counted in `dropped`."""
+
+    def __init__(self, name):
+        path = "/dev/shm/" + name.lstrip("/")
+        with open(path, "rb") as f:
+            if os.fstat(f.fileno()).st_size < TELEMETRY_HEADER_BYTES:
+                raise TelemetryNotReady(path)
+            self.buf = mmap.mmap(f.fileno(), 0, prot=mmap.PROT_READ)
+        magic = self.buf[:8]
+        if magic == bytes(8):
+            raise TelemetryNotReady(path)  # producer still initializing
+        if magic != TELEMETRY_MAGIC:
+            raise ValueError(f"{path} is not a telemetry segment")
+        version, self.width = np.frombuffer(self.buf, "<u4", 2, 8)
+        if version != TELEMETRY_VERSION:
+            raise ValueError(f"Unsupported telemetry version {version}")
+        self.capacity, slot_bytes, header_bytes = (
+            int(v) for v in np.frombuffer(self.buf, "<u8", 3, 16)
+        )
+        if len(self.buf) < header_bytes + self.capacity * slot_bytes:
+            raise ValueError(f"{path} is truncated")
+        self.meta = np.frombuffer(self.buf, "<u8", 4, 40)  # closed, ..., head
+        slot = np.dtype(
+            {
+                "names": ["seq", "id", "n", "t", "x"],
+                "formats": ["<u8", "<u4", "<u4", "<f8", ("<f8", self.width)],
+                "offsets": [0, 8, 12, 16, 24],
+                "itemsize": slot_bytes,
+            }
+        )
+        self.slots = np.frombuffer(self.buf, slot, self.capacity, header_bytes)
+        self.cursor = max(0, self.head() - self.capacity)
+        self.dropped = 0
+
+    def head(self):
+        return int(self.meta[3])
+
+    def closed(self):
+        return bool(self.meta[0])
+
+    def poll(self):
+        """All records published since the last poll: (id, t, x) arrays."""
+        head = self.head()
+        if head - self.cursor > self.capacity:
+            self.dropped += head - self.capacity - self.cursor
+            self.cursor = head - self.capacity
+        k = np.arange(self.cursor, head, dtype=np.uint64)
+        idx = (k % self.capacity).astype(np.intp)
+        seq = self.slots["seq"][idx].copy()
+        rec = self.slots[idx].copy()
+        good = (seq == 2 * k + 2) & (self.slots["seq"][idx] == seq)
+        self.dropped += int(np.count_nonzero(~good))
+        self.cursor = head
+        rec = rec[good]
+        return rec["id"], rec["t"], rec["x"]
+
+
+def earth_surface(R=6371.0, N=200):
+    u = np.linspace(-np.pi, np.pi, N)
+    v = np.linspace(0, np.pi, N)
+    U, V = np.meshgrid(u, v)
+    return R * np.sin(V) * np.cos(U), R * np.sin(V) * np.sin(U), R * np.cos(V)
+
+
+def plot_csv(path):
+    import plotly.graph_objects as go
+
+    # Load orbit data
+    data = np.loadtxt(path, delimiter=",", skiprows=1)
+    x, y, z = data[:, 1], data[:, 2], data[:, 3]
+
+    fig = go.Figure(layout=go.Layout(title=go.layout.Title(text="test")))
+
+    # Plot orbit
+    fig.add_scatter3d(
+        x=x, y=y, z=z, mode="lines", line=dict(color="red", width=4), name="Orbit"
+    )
+
+    # Plot sphere surface
+    X, Y, Z = earth_surface()
+    fig.add_surface(x=X, y=Y, z=Z, colorscale="blues", opacity=0.75)
+
+    fig.update_layout(
+        scene=dict(
+            aspectmode="data",
+            xaxis_title="X (km)",
+            yaxis_title="Y (km)",
+            zaxis_title="Z (km)",
+        ),
+        title="Satellite Orbit around Earth",
+    )
+
+    fig.show()
+
+
+def plot_live(name, period=0.2):
+    import matplotlib.pyplot as plt
+
+    # Wait for the run to create and initialize the segment
+    while True:
+        try:
+            reader = TelemetryReader(name)
+            break
+        except (FileNotFoundError, TelemetryNotReady):
+            time.sleep(period)
+
+    fig = plt.figure()
+    ax = fig.add_subplot(projection="3d")
+    X, Y, Z = earth_surface(N=40)
+    ax.plot_surface(X, Y, Z, color="tab:blue", alpha=0.3)
+    ax.set_xlabel("X (km)")
+    ax.set_ylabel("Y (km)")
+    ax.set_zlabel("Z (km)")
+    ax.set_title("Satellite Orbit around Earth (live)")
+
+    tracks, lines = {}, {}
+    while plt.fignum_exists(fig.number):
+        ids, t, x = reader.poll()
+        for i in np.unique(ids):
+            r = x[ids == i, :3]
+            tracks[i] = np.vstack([tracks.get(i, np.empty((0, 3))), r])
+            if i not in lines:
+                (lines[i],) = ax.plot([], [], [], label=f"id {i}")
+            lines[i].set_data_3d(*tracks[i].T)
+        if len(t):
+            ax.set_title(f"t = {t[-1]:.1f} s, dropped {reader.dropped}")
+            ax.set_aspect("equal")
+        if reader.closed() and reader.cursor == reader.head():
+            break
+        plt.pause(period)
+    plt.show()
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Plot oadcs orbits")
+    parser.add_argument("csv", nargs="?", default="build/orbit.csv")
+    parser.add_argument(
+        "--live",
+        metavar="NAME",
+        help="follow the telemetry segment NAME (OADCS_TELEMETRY of the run)",
+    )
+    args = parser.parse_args()
+    if args.live:
+        plot_live(args.live)
+    else:
+        plot_csv(args.csv)
@@ -0,0 +1,200 @@
+"""ctypes binding of liboadcs (include/oadcs.h).
+
+Input arrays that are float64 with contiguous rows (any row stride) are
+passed by pointer and row stride without a copy. Other inputs (another
+dtype, rows that are not contiguous) are copied once into a float64 array.
+Outputs are never copied: they are allocated here unless `out` is given,
+and `out` must already have the right layout. Every call handles a whole
+batch in C++ with the GIL released.
+
+    import numpy as np, oadcs
+    g = oadcs.Gravity(mu=398600.4418, R=6378.137, year=1984, degree=8)
+    xf = oadcs.propagate(g, x0, t0=0.0, tf=5400.0, dt=10.0)   # x0: (n, 6)
+    R = oadcs.ep_to_dcm(q)                                    # (n, 4) -> (n, 3, 3)
+
+The library is found from OADCS_LIB or build/ next to this file.
+"""
+
+import ctypes
+import os
+
+import numpy as np
+
+_here = os.path.dirname(os.path.abspath(__file__))
+_candidates = [os.environ.get("OADCS_LIB", "")] + [
+    os.path.join(_here, "build", "liboadcs" + ext)
+    for ext in (".so", ".dylib", ".dll")
+]
+_path = next((p for p in _candidates if p and os.path.exists(p)), None)
+if _path is None:
+    raise ImportError("liboadcs not found: build the oadcs target or set OADCS_LIB")
+_lib = ctypes.CDLL(_path)
+
+ABI_VERSION = 1
+if _lib.oadcs_abi_version() != ABI_VERSION:
+    raise ImportError(f"{_path} has an incompatible ABI version")
+
+_p = ctypes.c_void_p
+_n = ctypes.c_size_t
+_s = ctypes.c_ssize_t
+_d = ctypes.c_double
+_i = ctypes.c_int
+_seq = ctypes.POINTER(ctypes.c_int)
+
+_lib.oadcs_last_error.restype = ctypes.c_char_p
+_lib.oadcs_gravity_create.restype = _p
+_lib.oadcs_gravity_create.argtypes = [_d, _d, _i, _i, _i, _d]
+_lib.oadcs_gravity_load.restype = _p
+_lib.oadcs_gravity_load.argtypes = [ctypes.c_char_p, _d, _d, _i, _i, _i, _d]
+_lib.oadcs_gravity_destroy.argtypes = [_p]
+_lib.oadcs_gravity_accel.argtypes = [_p, _n, _p, _s, _p, _s, _p, _s]
+_lib.oadcs_propagate.argtypes = [_p, _n, _p, _s, _d, _d, _d, _p, _s, _i]
+_lib.oadcs_propagate_trajectory.argtypes = [_p, _p, _d, _d, _n, _p, _s]
+_lib.oadcs_propagate_j2.argtypes = [_n, _d, _d, _d, _p, _s, _d, _n, _p, _s]
+for _name in ("ep_to_dcm", "dcm_to_ep", "mrp_to_ep", "crp_to_ep"):
+    getattr(_lib, "oadcs_" + _name).argtypes = [_n, _p, _s, _p, _s]
+for _name in ("ea_to_dcm", "ea_to_ep"):
+    getattr(_lib, "oadcs_" + _name).argtypes = [_n, _p, _s, _seq, _p, _s]
+_lib.oadcs_ep_kde.argtypes = [_n, _p, _s, _p, _s, _p, _s]
+
+
+class OadcsError(RuntimeError):
+    pass
+
+
+def _check(status):
+    if status != 0:
+        raise OadcsError(_lib.oadcs_last_error().decode())
+
+
+def _rows(a, width):
+    """(array, n, pointer, row stride) for rows of `width` doubles.
+
+    Copies `a` when it is not float64 or its rows are not contiguous.
+    """
+    a = np.asarray(a, dtype=np.float64)
+    if a.shape[-1:] != (width,):
+        raise ValueError(f"expected rows of {width}, got shape {a.shape}")
+    a = a.reshape(-1, width) if a.ndim != 2 else a
+    if a.strides[1] != 8 or a.strides[0] % 8:
+        a = np.ascontiguousarray(a)
+    return a, a.shape[0], a.ctypes.data, a.strides[0]
+
+
+def _out(out, n, width):
+    """(out, pointer, row stride); out is written in place, never copied."""
+    if out is None:
+        out = np.empty((n, width))
+    rows = out.reshape(n, width) if out.ndim == 3 else out
+    if (
+        rows.dtype != np.float64
+        or rows.shape != (n, width)
+        or rows.strides[1] != 8
+        or not rows.flags.writeable
+        or not np.shares_memory(rows, out)
+    ):
+        raise ValueError(f"out must be a writable float64 array of {n} rows")
+    return out, rows.ctypes.data, rows.strides[0]
+
+
+class Gravity:
+    """Spherical harmonic gravity (central term included)."""
+
+    def __init__(
+        self, mu, R, year=1984, degree=8, order=None, tol=0.0, path=None
+    ):
+        order = degree if order is None else order
+        if path is None:
+            self._h = _lib.oadcs_gravity_create(mu, R, year, degree, order, tol)
+        else:
+            self._h = _lib.oadcs_gravity_load(
+                os.fsencode(path), mu, R, year, degree, order, tol
+            )
+        if not self._h:
+            raise OadcsError(_lib.oadcs_last_error().decode())
+
+    def __del__(self):
+        if getattr(self, "_h", None):
+            _lib.oadcs_gravity_destroy(self._h)
+            self._h = None
+
+    def acceleration(self, r, t=0.0, out=None):
+        r, n, pr, sr = _rows(r, 3)
+        t, _, pt, st = _rows(np.reshape(np.asarray(t, np.float64), (-1, 1)), 1)
+        if len(t) == 1:
+            st = 0
+        elif len(t) != n:
+            raise ValueError("t must be a scalar or one time per position")
+        out, pa, sa = _out(out, n, 3)
+        _check(_lib.oadcs_gravity_accel(self._h, n, pt, st, pr, sr, pa, sa))
+        return out
+
+
+def propagate(g, x0, t0, tf, dt, out=None, n_threads=0):
+    x0, n, px, sx = _rows(x0, 6)
+    out, po, so = _out(out, n, 6)
+    _check(_lib.oadcs_propagate(g._h, n, px, sx, t0, tf, dt, po, so, n_threads))
+    return out
+
+
+def trajectory(g, x0, t0, dt, n_steps, out=None):
+    x0, n, px, _ = _rows(x0, 6)
+    if n != 1:
+        raise ValueError("trajectory takes one initial state")
+    out, po, so = _out(out, n_steps + 1, 6)
+    _check(_lib.oadcs_propagate_trajectory(g._h, px, t0, dt, n_steps, po, so))
+    return out
+
+
+def propagate_j2(x0, dt, n_steps, mu, J2, R, out=None):
+    x0, n, px, sx = _rows(x0, 6)
+    out, po, so = _out(out, n, 6)
+    _check(_lib.oadcs_propagate_j2(n, mu, J2, R, px, sx, dt, n_steps, po, so))
+    return out
+
+
+def _convert(name, a, w_in, w_out, *extra, out=None):
+    a, n, pa, sa = _rows(a, w_in)
+    out, po, so = _out(out, n, w_out)
+    _check(getattr(_lib, "oadcs_" + name)(n, pa, sa, *extra, po, so))
+    return out
+
+
+def _sequence(seq):
+    return (ctypes.c_int * 3)(*seq)
+
+
+def ep_to_dcm(q, out=None):
+    return _convert("ep_to_dcm", q, 4, 9, out=out).reshape(-1, 3, 3)
+
+
+def dcm_to_ep(R, out=None):
+    R = np.asarray(R, dtype=np.float64)
+    return _convert("dcm_to_ep", R.reshape(R.shape[:-2] + (9,)), 9, 4, out=out)
+
+
+def ea_to_dcm(angles, seq, out=None):
+    R = _convert("ea_to_dcm", angles, 3, 9, _sequence(seq), out=out)
+    return R.reshape(-1, 3, 3)
+
+
+def ea_to_ep(angles, seq, out=None):
+    return _convert("ea_to_ep", angles, 3, 4, _sequence(seq), out=out)
+
+
+def mrp_to_ep(p, out=None):
+    return _convert("mrp_to_ep", p, 3, 4, out=out)
+
+
+def crp_to_ep(p, out=None):
+    return _convert("crp_to_ep", p, 3, 4, out=out)
+
+
+def ep_kde(q, w, out=None):
+    q, n, pq, sq = _rows(q, 4)
+    w, m, pw, sw = _rows(w, 3)
+    if m != n:
+        raise ValueError("q and w must have the same number of rows")
+    out, po, so = _out(out, n, 4)
+    _check(_lib.oadcs_ep_kde(n, pq, sq, pw, sw, po, so))
+    return out
@@ -0,0 +1,485 @@
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "attitude.h"
+#include "batch.h"
+#include "egm_embedded.h"
+#include "gravity.h"
+#include "integrator.h"
+#include "oadcs.h"
+#include "parallel.h"
+#include "registry.h"
+#include "typedefs.h"
+
+// -----------------------------------------------------------------------------
+// C ABI (include/oadcs.h)
+// -----------------------------------------------------------------------------
+// Thin layer over the header-only library: validates the buffers, maps the
+// strided rows onto Eigen vectors and turns exceptions into status codes.
+
+using Gravity = SphericalHarmonicGravityPolicy<vec6>;
+using GravityEOM = EOM<vec6, ForcePolicy3D<vec6, Gravity>>;
+
+struct oadcs_gravity {
+    GravityEOM eom;
+};
+
+namespace {
+
+thread_local std::string last_error;
+
+int fail(int status, std::string msg) {
+    last_error = std::move(msg);
+    return status;
+}
+
+// Runs fn, turning an escaping exception into OADCS_ERROR
+template <typename Fn> int guarded(Fn &&fn) {
+    try {
+        return fn();
+    } catch (const std::invalid_argument &e) {
+        return fail(OADCS_EINVAL, e.what());
+    } catch (const std::exception &e) {
+        return fail(OADCS_ERROR, e.what());
+    } catch (...) {
+        return fail(OADCS_ERROR, "unknown error");
+    }
+}
+
+bool aligned(const void *p, ptrdiff_t stride) {
+    return reinterpret_cast<std::uintptr_t>(p) % alignof(f64) == 0
+           && stride % static_cast<ptrdiff_t>(alignof(f64)) == 0;
+}
+
+// Row i of a strided buffer
+template <typename T> T *row(T *p, ptrdiff_t stride, size_t i) {
+    using B = std::conditional_t<std::is_const_v<T>, const char, char>;
+    return reinterpret_cast<T *>(
+        reinterpret_cast<B *>(p) + stride * static_cast<ptrdiff_t>(i)
+    );
+}
+
+template <int N> using RowIn = eig::Map<const eig::Matrix<f64, N, 1>>;
+template <int N> using RowOut = eig::Map<eig::Matrix<f64, N, 1>>;
+using DcmIn = eig::Map<const eig::Matrix<f64, 3, 3, eig::RowMajor>>;
+using DcmOut = eig::Map<eig::Matrix<f64, 3, 3, eig::RowMajor>>;
+
+// Validates one buffer argument; 0 or a status for fail()
+struct Check {
+    int status = OADCS_OK;
+
+    Check &buffer(const char *name, const void *p, ptrdiff_t stride, size_t n) {
+        if (status != OADCS_OK || n == 0) {
+            return *this;
+        }
+        if (!p) {
+            status = fail(OADCS_EINVAL, std::string(name) + " is null");
+        } else if (!aligned(p, stride)) {
+            status = fail(
+                OADCS_EINVAL, std::string(name) + " is not 8-byte aligned"
+            );
+        }
+        return *this;
+    }
+};
+
+// Whether steps of dt still move a clock that reaches |t| (finite, dt > 0)
+bool steps_resolve(f64 t, f64 dt) {
+    return std::isfinite(t) && std::abs(t) + dt > std::abs(t);
+}
+
+vec3 sequence(const int seq[3]) {
+    if (!seq) {
+        throw std::invalid_argument("seq is null");
+    }
+    for (int i = 0; i < 3; i++) {
+        if (seq[i] < 1 || seq[i] > 3) {
+            throw std::invalid_argument("seq axes must be 1, 2 or 3");
+        }
+    }
+    return vec3(seq[0], seq[1], seq[2]);
+}
+
+oadcs_gravity *make_gravity(
+    const EGMCoefficients &egm,
+    double mu,
+    double R,
+    double tol
+) {
+    Gravity g(mu, R, egm, nullptr, tol, true);
+    return new oadcs_gravity{GravityEOM(ForcePolicy3D<vec6, Gravity>(g))};
+}
+
+// Elementwise map from rows of I values to rows of O values
+template <int I, int O, typename Fn>
+int map_rows(
+    size_t n,
+    const double *in,
+    ptrdiff_t in_stride,
+    double *out,
+    ptrdiff_t out_stride,
+    Fn &&fn
+) {
+    Check c;
+    c.buffer("input", in, in_stride, n).buffer("output", out, out_stride, n);
+    if (c.status) {
+        return c.status;
+    }
+    return guarded([&] {
+        for (size_t i = 0; i < n; i++) {
+            eig::Matrix<f64, O, 1> y = fn(RowIn<I>(row(in, in_stride, i)));
+            RowOut<O>(row(out, out_stride, i)) = y;
+        }
+        return OADCS_OK;
+    });
+}
+
+} // namespace
+
+extern "C" {
+
+int oadcs_abi_version(void) { return OADCS_ABI_VERSION; }
+
+const char *oadcs_last_error(void) { return last_error.c_str(); }
+
+// --- Gravity models
+
+oadcs_gravity *oadcs_gravity_create(
+    double mu,
+    double R,
+    int year,
+    int degree,
+    int order,
+    double tol
+) {
+    try {
+        return make_gravity(embedded_egm(year, degree, order), mu, R, tol);
+    } catch (const std::exception &e) {
+        fail(OADCS_ERROR, e.what());
+        return nullptr;
+    } catch (...) {
+        fail(OADCS_ERROR, "unknown error");
+        return nullptr;
+    }
+}
+
+oadcs_gravity *oadcs_gravity_load(
+    const char *path,
+    double mu,
+    double R,
+    int year,
+    int degree,
+    int order,
+    double tol
+) {
+    try {
+        if (!path) {
+            throw std::invalid_argument("path is null");
+        }
+        EGMCoefficients egm(degree, order);
+        egm.load_egm(path, year);
+        return make_gravity(egm, mu, R, tol);
+    } catch (const std::exception &e) {
+        fail(OADCS_ERROR, e.what());
+        return nullptr;
+    } catch (...) {
+        fail(OADCS_ERROR, "unknown error");
+        return nullptr;
+    }
+}
+
+void oadcs_gravity_destroy(oadcs_gravity *g) { delete g; }
+
+int oadcs_gravity_accel(
+    const oadcs_gravity *g,
+    size_t n,
+    const double *t,
+    ptrdiff_t t_stride,
+    const double *r,
+    ptrdiff_t r_stride,
+    double *a,
+    ptrdiff_t a_stride
+) {
+    if (!g) {
+        return fail(OADCS_EINVAL, "gravity model is null");
+    }
+    Check c;
+    c.buffer("t", t, t_stride, n)
+        .buffer("r", r, r_stride, n)
+        .buffer("a", a, a_stride, n);
+    if (c.status) {
+        return c.status;
+    }
+    return guarded([&] {
+        vec6 x = vec6::Zero();
+        for (size_t i = 0; i < n; i++) {
+            x.head<3>() = RowIn<3>(row(r, r_stride, i));
+            RowOut<3>(row(a, a_stride, i))
+                = g->eom.forces.acceleration(*row(t, t_stride, i), x);
+        }
+        return OADCS_OK;
+    });
+}
+
+// --- Propagation
+
+int oadcs_propagate(
+    const oadcs_gravity *g,
+    size_t n,
+    const double *x0,
+    ptrdiff_t x0_stride,
+    double t0,
+    double tf,
+    double dt,
+    double *xf,
+    ptrdiff_t xf_stride,
+    int n_threads
+) {
+    if (!g) {
+        return fail(OADCS_EINVAL, "gravity model is null");
+    }
+    if (!(dt > 0.) || !std::isfinite(dt) || !(tf >= t0)) {
+        return fail(OADCS_EINVAL, "need finite dt > 0 and tf >= t0");
+    }
+    if (!steps_resolve(t0, dt) || !steps_resolve(tf, dt)) {
+        return fail(OADCS_EINVAL, "dt is below the resolution of t0 or tf");
+    }
+    if (n > static_cast<size_t>(INT_MAX)) {
+        return fail(OADCS_EINVAL, "n exceeds INT_MAX");
+    }
+    Check c;
+    c.buffer("x0", x0, x0_stride, n).buffer("xf", xf, xf_stride, n);
+    if (c.status) {
+        return c.status;
+    }
+    return guarded([&] {
+        parallel_for(
+            static_cast<int>(n),
+            [&](int i) {
+                // Step k ends at t0 + k dt, the last one exactly at tf
+                using Step = RK4Policy<GravityEOM, vec6>;
+                vec6 x = RowIn<6>(row(x0, x0_stride, i));
+                f64 t = t0;
+                for (f64 k = 1.; t < tf; k++) {
+                    f64 t_next = std::min(t0 + k * dt, tf);
+                    x = Step::step(g->eom, t, x, t_next - t).second;
+                    t = t_next;
+                }
+                RowOut<6>(row(xf, xf_stride, i)) = x;
+            },
+            n_threads
+        );
+        return OADCS_OK;
+    });
+}
+
+int oadcs_propagate_trajectory(
+    const oadcs_gravity *g,
+    const double *x0,
+    double t0,
+    double dt,
+    size_t n_steps,
+    double *out,
+    ptrdiff_t out_stride
+) {
+    if (!g) {
+        return fail(OADCS_EINVAL, "gravity model is null");
+    }
+    if (!(dt > 0.) || !std::isfinite(dt) || n_steps == SIZE_MAX) {
+        return fail(OADCS_EINVAL, "need finite dt > 0 and n_steps < SIZE_MAX");
+    }
+    f64 tf = t0 + static_cast<f64>(n_steps) * dt;
+    if (!steps_resolve(t0, dt) || !steps_resolve(tf, dt)) {
+        return fail(OADCS_EINVAL, "dt is below the resolution of the times");
+    }
+    Check c;
+    c.buffer("x0", x0, 0, 1).buffer("out", out, out_stride, n_steps + 1);
+    if (c.status) {
+        return c.status;
+    }
+    return guarded([&] {
+        vec6 x = RowIn<6>(x0);
+        RowOut<6>(row(out, out_stride, 0)) = x;
+        for (size_t k = 1; k <= n_steps; k++) {
+            f64 t = t0 + static_cast<f64>(k - 1) * dt;
+            x = RK4Policy<GravityEOM, vec6>::step(g->eom, t, x, dt).second;
+            RowOut<6>(row(out, out_stride, k)) = x;
+        }
+        return OADCS_OK;
+    });
+}
+
+int oadcs_propagate_j2(
+    size_t n,
+    double mu,
+    double J2,
+    double R,
+    const double *x0,
+    ptrdiff_t x0_stride,
+    double dt,
+    size_t n_steps,
+    double *xf,
+    ptrdiff_t xf_stride
+) {
+    if (n > static_cast<size_t>(INT_MAX)) {
+        return fail(OADCS_EINVAL, "n exceeds INT_MAX");
+    }
+    if (!std::isfinite(dt)) {
+        return fail(OADCS_EINVAL, "dt is not finite");
+    }
+    Check c;
+    c.buffer("x0", x0, x0_stride, n).buffer("xf", xf, xf_stride, n);
+    if (c.status) {
+        return c.status;
+    }
+    return guarded([&] {
+        Registry reg;
+        for (size_t i = 0; i < n; i++) {
+            reg.set_state(reg.create(""), RowIn<6>(row(x0, x0_stride, i)));
+        }
+        BatchTranslation batch(mu, J2, R);
+        for (size_t k = 0; k < n_steps; k++) {
+            batch.step(reg, dt);
+        }
+        for (size_t i = 0; i < n; i++) {
+            RowOut<6>(row(xf, xf_stride, i)) = reg.state(Entity(i));
+        }
+        return OADCS_OK;
+    });
+}
+
+// --- Attitude
+
+int oadcs_ep_to_dcm(
+    size_t n,
+    const double *q,
+    ptrdiff_t q_stride,
+    double *R,
+    ptrdiff_t R_stride
+) {
+    return map_rows<4, 9>(n, q, q_stride, R, R_stride, [](const auto &ep) {
+        mat3 M = ep_to_dcm<f64>(ep);
+        eig::Matrix<f64, 9, 1> y;
+        DcmOut(y.data()) = M;
+        return y;
+    });
+}
+
+int oadcs_dcm_to_ep(
+    size_t n,
+    const double *R,
+    ptrdiff_t R_stride,
+    double *q,
+    ptrdiff_t q_stride
+) {
+    return map_rows<9, 4>(n, R, R_stride, q, q_stride, [](const auto &r) {
+        mat3 M = DcmIn(r.data());
+        return dcm_to_ep<f64>(M);
+    });
+}
+
+int oadcs_ea_to_dcm(
+    size_t n,
+    const double *angles,
+    ptrdiff_t angles_stride,
+    const int seq[3],
+    double *R,
+    ptrdiff_t R_stride
+) {
+    return guarded([&] {
+        vec3 s = sequence(seq);
+        return map_rows<3, 9>(
+            n,
+            angles,
+            angles_stride,
+            R,
+            R_stride,
+            [&](const auto &a) {
+                mat3 M = ea_to_dcm<f64>(vec3(a), s);
+                eig::Matrix<f64, 9, 1> y;
+                DcmOut(y.data()) = M;
+                return y;
+            }
+        );
+    });
+}
+
+int oadcs_ea_to_ep(
+    size_t n,
+    const double *angles,
+    ptrdiff_t angles_stride,
+    const int seq[3],
+    double *q,
+    ptrdiff_t q_stride
+) {
+    return guarded([&] {
+        vec3 s = sequence(seq);
+        return map_rows<3, 4>(
+            n,
+            angles,
+            angles_stride,
+            q,
+            q_stride,
+            [&](const auto &a) { return ea_to_ep<f64>(vec3(a), s); }
+        );
+    });
+}
+
+int oadcs_mrp_to_ep(
+    size_t n,
+    const double *p,
+    ptrdiff_t p_stride,
+    double *q,
+    ptrdiff_t q_stride
+) {
+    return map_rows<3, 4>(n, p, p_stride, q, q_stride, [](const auto &m) {
+        return mrp_to_ep<f64>(vec3(m));
+    });
+}
+
+int oadcs_crp_to_ep(
+    size_t n,
+    const double *p,
+    ptrdiff_t p_stride,
+    double *q,
+    ptrdiff_t q_stride
+) {
+    return map_rows<3, 4>(n, p, p_stride, q, q_stride, [](const auto &c) {
+        return crp_to_ep<f64>(vec3(c));
+    });
+}
+
+int oadcs_ep_kde(
+    size_t n,
+    const double *q,
+    ptrdiff_t q_stride,
+    const double *w,
+    ptrdiff_t w_stride,
+    double *dq,
+    ptrdiff_t dq_stride
+) {
+    Check c;
+    c.buffer("q", q, q_stride, n)
+        .buffer("w", w, w_stride, n)
+        .buffer("dq", dq, dq_stride, n);
+    if (c.status) {
+        return c.status;
+    }
+    return guarded([&] {
+        for (size_t i = 0; i < n; i++) {
+            vec4 ep = RowIn<4>(row(q, q_stride, i));
+            vec3 omega = RowIn<3>(row(w, w_stride, i));
+            RowOut<4>(row(dq, dq_stride, i)) = ep_kde<f64>(ep, omega);
+        }
+        return OADCS_OK;
+    });
+}
+
+} // extern "C"
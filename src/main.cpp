@@ -1,12 +1,16 @@
 #include <chrono>
 #include <cmath>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <vector>
 
 #include "FixedIntegrators.h"
+#include "egm_embedded.h"
 #include "gravity.h"
-#include "Integrator.h"
+#include "integrator.h"
+#include "scenario.h"
+#include "telemetry.h"
 #include "typedefs.h"
 
 vec6 gravity_newton(f64 t, vec6 x, f64 mu) {
@@ -22,7 +26,76 @@ vec6 gravity_newton(f64 t, vec6 x, f64 mu) {
     return dxdt;
 }
 
-int main() {
+// oadcs_project [-j threads] [-o out_dir] [--assets dir] scenario...
+int run_batch(int argc, char **argv) {
+    int n_threads = 0;
+    std::string out_dir = ".", assets = "assets";
+    std::vector<Scenario> scenarios;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if ((arg == "-j" || arg == "-o" || arg == "--assets") && i + 1 < argc) {
+            std::string val = argv[++i];
+            if (arg == "-j") {
+                try {
+                    n_threads = detail::parse_int(val);
+                } catch (const std::logic_error &) {
+                    n_threads = -1;
+                }
+                if (n_threads < 0) {
+                    std::cerr << "-j expects a thread count, got " << val
+                              << std::endl;
+                    return 1;
+                }
+            } else if (arg == "-o") {
+                out_dir = val;
+            } else {
+                assets = val;
+            }
+            continue;
+        }
+        try {
+            scenarios.push_back(load_scenario(arg));
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    ModelCache cache(assets);
+    auto t_start = std::chrono::steady_clock::now();
+    std::vector<ScenarioResult> results;
+    try {
+        results
+            = run_scenarios(scenarios, cache, file_sink(out_dir), n_threads);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    std::chrono::duration<f64> elapsed
+        = std::chrono::steady_clock::now() - t_start;
+
+    int failed = 0;
+    for (const ScenarioResult &r : results) {
+        if (r.ok) {
+            std::cout << r.name << ": " << r.steps << " steps, "
+                      << r.seconds << " s, |r_f| " << r.xf.head<3>().norm()
+                      << " km\n";
+        } else {
+            std::cout << r.name << ": FAILED: " << r.error << "\n";
+            failed++;
+        }
+    }
+    std::cout << results.size() << " scenarios (" << failed << " failed) in "
+              << elapsed.count() << " s, " << cache.builds()
+              << " models built" << std::endl;
+    return failed ? 1 : 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1) {
+        return run_batch(argc, argv);
+    }
+
     // Gravitational parameter for Earth (km^3/s^2)
     const f64 mu = 398600.4418;
 
@@ -61,7 +134,14 @@ int main() {
     std::vector<f64> times;
     std::vector<vec6> states;
     auto t_start = std::chrono::high_resolution_clock::now();
-    rk4.integrate(t0, tf, x0, times, states);
+    if (const char *live = std::getenv("OADCS_TELEMETRY")) {
+        // Live feed for main.py --live, e.g. OADCS_TELEMETRY=/oadcs
+        TelemetryRing ring = TelemetryRing::shared(live, 1 << 14, 6);
+        TelemetryTap tap(ring, 0, times, states);
+        rk4.integrate(t0, tf, x0, tap.times, tap.states);
+    } else {
+        rk4.integrate(t0, tf, x0, times, states);
+    }
     auto t_end = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> elapsed = t_end - t_start;
     std::cout << "Total runtime: " << elapsed.count() << " seconds\n";
@@ -80,8 +160,7 @@ int main() {
 
     // std::cout << std::filesystem::current_path() << std::endl;
     int max_degree = 4, max_order = 3;
-    EGMCoefficients egm(max_degree, max_order);
-    egm.load_egm("../assets/EGM2008.txt", 2008);
+    EGMCoefficients egm = embedded_egm(1984, max_degree, max_order);
 
     for (int i = 0; i <= max_degree; i++) {
         for (int j = 0; j <= max_order; j++) {
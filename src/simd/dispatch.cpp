@@ -0,0 +1,78 @@
+#include <cstdlib>
+#include <cstring>
+
+#include "simd.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+SimdIsa simd_detect() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    // libgcc checks both the CPUID bits and that the OS saves the YMM/ZMM
+    // state (XGETBV)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return SimdIsa::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdIsa::AVX2;
+    }
+    return SimdIsa::BASELINE;
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int r[4];
+    __cpuid(r, 1);
+    bool osxsave = (r[2] & (1 << 27)) != 0;
+    bool avx = (r[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) {
+        return SimdIsa::BASELINE;
+    }
+    unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(r, 7, 0);
+    bool avx2 = (r[1] & (1 << 5)) != 0;
+    bool avx512f = (r[1] & (1 << 16)) != 0;
+    if (avx512f && (xcr0 & 0xE6) == 0xE6) {
+        return SimdIsa::AVX512;
+    }
+    if (avx2 && (xcr0 & 0x6) == 0x6) {
+        return SimdIsa::AVX2;
+    }
+    return SimdIsa::BASELINE;
+#else
+    return SimdIsa::BASELINE;
+#endif
+}
+
+namespace {
+const SimdKernels *select_kernels() {
+    SimdIsa isa = simd_detect();
+
+    // Optional cap from the environment
+    if (const char *env = std::getenv("OADCS_SIMD")) {
+        if (std::strcmp(env, "baseline") == 0) {
+            isa = SimdIsa::BASELINE;
+        } else if (std::strcmp(env, "avx2") == 0 && isa == SimdIsa::AVX512) {
+            isa = SimdIsa::AVX2;
+        }
+    }
+
+    // Fall back when a variant was not built (non-x86 compiler)
+    const SimdKernels *k = nullptr;
+    if (isa == SimdIsa::AVX512) {
+        k = simd_kernels_avx512();
+    }
+    if (!k && isa != SimdIsa::BASELINE) {
+        k = simd_kernels_avx2();
+    }
+    if (!k) {
+        k = simd_kernels_baseline();
+    }
+    return k;
+}
+} // namespace
+
+const SimdKernels &simd_kernels() {
+    static const SimdKernels *k = select_kernels();
+    return *k;
+}
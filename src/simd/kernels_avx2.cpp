@@ -0,0 +1,18 @@
+// Compiled with AVX2 enabled (see CMakeLists.txt)
+#include <cmath>
+
+#include "simd.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+namespace {
+#include "kernels_impl.h"
+} // namespace
+
+const SimdKernels *simd_kernels_avx2() {
+    return make_kernels(SimdIsa::AVX2, "avx2");
+}
+#else
+const SimdKernels *simd_kernels_avx2() { return nullptr; }
+#endif
@@ -0,0 +1,18 @@
+// Compiled with AVX-512F enabled (see CMakeLists.txt)
+#include <cmath>
+
+#include "simd.h"
+
+#if defined(__AVX512F__)
+#include <immintrin.h>
+
+namespace {
+#include "kernels_impl.h"
+} // namespace
+
+const SimdKernels *simd_kernels_avx512() {
+    return make_kernels(SimdIsa::AVX512, "avx512");
+}
+#else
+const SimdKernels *simd_kernels_avx512() { return nullptr; }
+#endif
@@ -0,0 +1,11 @@
+#include <cmath>
+
+#include "simd.h"
+
+namespace {
+#include "kernels_impl.h"
+} // namespace
+
+const SimdKernels *simd_kernels_baseline() {
+    return make_kernels(SimdIsa::BASELINE, "baseline");
+}
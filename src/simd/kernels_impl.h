@@ -0,0 +1,271 @@
+// Kernel bodies shared by the per-ISA translation units. Each unit includes
+// this file inside its own namespace after setting its target flags; the
+// loops are written for the auto-vectorizer (independent iterations,
+// restrict pointers, no calls besides sqrt). Philox is the exception: the
+// compilers do not vectorize its 32x32->64 multiplies, so the AVX2 and
+// AVX-512 units get explicit intrinsics (the unit includes immintrin.h).
+//
+// No include guard: included once per kernel translation unit.
+
+#define KERNEL_RESTRICT __restrict
+
+static void gravity_j2(
+    size_t n,
+    const double *KERNEL_RESTRICT r,
+    double *KERNEL_RESTRICT a,
+    double mu,
+    double J2,
+    double R
+) {
+    const double *x = r;
+    const double *y = r + n;
+    const double *z = r + 2 * n;
+    double *ax = a;
+    double *ay = a + n;
+    double *az = a + 2 * n;
+    const double k = -1.5 * J2 * mu * R * R;
+    for (size_t i = 0; i < n; i++) {
+        double r2 = x[i] * x[i] + y[i] * y[i] + z[i] * z[i];
+        double r_mag = std::sqrt(r2);
+        double ir2 = 1. / r2;
+        double ir3 = ir2 / r_mag;
+        double z2 = z[i] * z[i] * ir2;
+        // J2 term over r: coef * (1 - 5 z^2/r^2) / r, coef = k / r^4
+        double c = k * ir2 * ir3;
+        double cxy = c * (1. - 5. * z2);
+        double cz = c * (3. - 5. * z2);
+        ax[i] = -mu * ir3 * x[i] + cxy * x[i];
+        ay[i] = -mu * ir3 * y[i] + cxy * y[i];
+        az[i] = -mu * ir3 * z[i] + cz * z[i];
+    }
+}
+
+static void axpy(
+    size_t n,
+    double h,
+    const double *KERNEL_RESTRICT k,
+    const double *KERNEL_RESTRICT x,
+    double *KERNEL_RESTRICT out
+) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = x[i] + h * k[i];
+    }
+}
+
+static void rk4_combine(
+    size_t n,
+    double h,
+    const double *KERNEL_RESTRICT x,
+    const double *KERNEL_RESTRICT k1,
+    const double *KERNEL_RESTRICT k2,
+    const double *KERNEL_RESTRICT k3,
+    const double *KERNEL_RESTRICT k4,
+    double *KERNEL_RESTRICT out
+) {
+    const double h6 = h / 6.;
+    for (size_t i = 0; i < n; i++) {
+        out[i] = x[i] + h6 * (k1[i] + 2. * k2[i] + 2. * k3[i] + k4[i]);
+    }
+}
+
+static void ep_to_dcm(
+    size_t n,
+    const double *KERNEL_RESTRICT q,
+    double *KERNEL_RESTRICT R
+) {
+    const double *q1 = q;
+    const double *q2 = q + n;
+    const double *q3 = q + 2 * n;
+    const double *q4 = q + 3 * n;
+    for (size_t i = 0; i < n; i++) {
+        double a = q1[i], b = q2[i], c = q3[i], d = q4[i];
+        double as = a * a, bs = b * b, cs = c * c, ds = d * d;
+        R[0 * n + i] = as - bs - cs + ds;
+        R[1 * n + i] = 2. * (a * b + c * d);
+        R[2 * n + i] = 2. * (a * c - b * d);
+        R[3 * n + i] = 2. * (b * a - c * d);
+        R[4 * n + i] = -as + bs - cs + ds;
+        R[5 * n + i] = 2. * (b * c + a * d);
+        R[6 * n + i] = 2. * (c * a + b * d);
+        R[7 * n + i] = 2. * (c * b - a * d);
+        R[8 * n + i] = -as - bs + cs + ds;
+    }
+}
+
+static void ep_kde(
+    size_t n,
+    const double *KERNEL_RESTRICT q,
+    const double *KERNEL_RESTRICT w,
+    double *KERNEL_RESTRICT dq
+) {
+    for (size_t i = 0; i < n; i++) {
+        double e1 = q[i], e2 = q[n + i], e3 = q[2 * n + i], e4 = q[3 * n + i];
+        double o1 = w[i], o2 = w[n + i], o3 = w[2 * n + i];
+        dq[i] = 0.5 * (o3 * e2 - o2 * e3 + o1 * e4);
+        dq[n + i] = 0.5 * (-o3 * e1 + o1 * e3 + o2 * e4);
+        dq[2 * n + i] = 0.5 * (o2 * e1 - o1 * e2 + o3 * e4);
+        dq[3 * n + i] = 0.5 * (-o1 * e1 - o2 * e2 - o3 * e3);
+    }
+}
+
+// Philox4x32-10 constants, as in random.h
+constexpr uint32_t philox_m0 = 0xD2511F53;
+constexpr uint32_t philox_m1 = 0xCD9E8D57;
+constexpr uint32_t philox_w0 = 0x9E3779B9;
+constexpr uint32_t philox_w1 = 0xBB67AE85;
+
+// Counters [i0, n), one at a time
+static void philox4x32_tail(
+    size_t i0,
+    size_t n,
+    const uint32_t *KERNEL_RESTRICT ctr,
+    uint32_t *KERNEL_RESTRICT out,
+    uint32_t k0,
+    uint32_t k1
+) {
+    for (size_t i = i0; i < n; i++) {
+        uint32_t c0 = ctr[i], c1 = ctr[n + i];
+        uint32_t c2 = ctr[2 * n + i], c3 = ctr[3 * n + i];
+        uint32_t key0 = k0, key1 = k1;
+        for (int r = 0; r < 10; r++) {
+            uint64_t p0 = uint64_t(philox_m0) * c0;
+            uint64_t p1 = uint64_t(philox_m1) * c2;
+            c0 = uint32_t(p1 >> 32) ^ c1 ^ key0;
+            c1 = uint32_t(p1);
+            c2 = uint32_t(p0 >> 32) ^ c3 ^ key1;
+            c3 = uint32_t(p0);
+            key0 += philox_w0;
+            key1 += philox_w1;
+        }
+        out[i] = c0;
+        out[n + i] = c1;
+        out[2 * n + i] = c2;
+        out[3 * n + i] = c3;
+    }
+}
+
+#if defined(__AVX512F__)
+// 16 counters per vector. mul_epu32 multiplies the even 32-bit lanes into
+// 64-bit products; the odd lanes go through a second multiply after a shift.
+static inline void
+philox_mulhilo(__m512i a, __m512i m, __m512i &hi, __m512i &lo) {
+    __m512i even = _mm512_mul_epu32(a, m);
+    __m512i odd = _mm512_mul_epu32(_mm512_srli_epi64(a, 32), m);
+    lo = _mm512_mask_blend_epi32(0xAAAA, even, _mm512_slli_epi64(odd, 32));
+    hi = _mm512_mask_blend_epi32(0xAAAA, _mm512_srli_epi64(even, 32), odd);
+}
+
+static void philox4x32(
+    size_t n,
+    const uint32_t *KERNEL_RESTRICT ctr,
+    uint32_t *KERNEL_RESTRICT out,
+    uint32_t k0,
+    uint32_t k1
+) {
+    const __m512i m0 = _mm512_set1_epi32(int(philox_m0));
+    const __m512i m1 = _mm512_set1_epi32(int(philox_m1));
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i c0 = _mm512_loadu_si512(ctr + i);
+        __m512i c1 = _mm512_loadu_si512(ctr + n + i);
+        __m512i c2 = _mm512_loadu_si512(ctr + 2 * n + i);
+        __m512i c3 = _mm512_loadu_si512(ctr + 3 * n + i);
+        uint32_t key0 = k0, key1 = k1;
+        for (int r = 0; r < 10; r++) {
+            __m512i hi0, lo0, hi1, lo1;
+            philox_mulhilo(c0, m0, hi0, lo0);
+            philox_mulhilo(c2, m1, hi1, lo1);
+            c0 = _mm512_xor_si512(
+                _mm512_xor_si512(hi1, c1), _mm512_set1_epi32(int(key0))
+            );
+            c1 = lo1;
+            c2 = _mm512_xor_si512(
+                _mm512_xor_si512(hi0, c3), _mm512_set1_epi32(int(key1))
+            );
+            c3 = lo0;
+            key0 += philox_w0;
+            key1 += philox_w1;
+        }
+        _mm512_storeu_si512(out + i, c0);
+        _mm512_storeu_si512(out + n + i, c1);
+        _mm512_storeu_si512(out + 2 * n + i, c2);
+        _mm512_storeu_si512(out + 3 * n + i, c3);
+    }
+    philox4x32_tail(i, n, ctr, out, k0, k1);
+}
+#elif defined(__AVX2__)
+// 8 counters per vector, multiplies as in the AVX-512 variant
+static inline void
+philox_mulhilo(__m256i a, __m256i m, __m256i &hi, __m256i &lo) {
+    __m256i even = _mm256_mul_epu32(a, m);
+    __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), m);
+    lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+    hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+}
+
+static inline __m256i philox_load(const uint32_t *p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+}
+
+static inline void philox_store(uint32_t *p, __m256i v) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v);
+}
+
+static void philox4x32(
+    size_t n,
+    const uint32_t *KERNEL_RESTRICT ctr,
+    uint32_t *KERNEL_RESTRICT out,
+    uint32_t k0,
+    uint32_t k1
+) {
+    const __m256i m0 = _mm256_set1_epi32(int(philox_m0));
+    const __m256i m1 = _mm256_set1_epi32(int(philox_m1));
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i c0 = philox_load(ctr + i);
+        __m256i c1 = philox_load(ctr + n + i);
+        __m256i c2 = philox_load(ctr + 2 * n + i);
+        __m256i c3 = philox_load(ctr + 3 * n + i);
+        uint32_t key0 = k0, key1 = k1;
+        for (int r = 0; r < 10; r++) {
+            __m256i hi0, lo0, hi1, lo1;
+            philox_mulhilo(c0, m0, hi0, lo0);
+            philox_mulhilo(c2, m1, hi1, lo1);
+            c0 = _mm256_xor_si256(
+                _mm256_xor_si256(hi1, c1), _mm256_set1_epi32(int(key0))
+            );
+            c1 = lo1;
+            c2 = _mm256_xor_si256(
+                _mm256_xor_si256(hi0, c3), _mm256_set1_epi32(int(key1))
+            );
+            c3 = lo0;
+            key0 += philox_w0;
+            key1 += philox_w1;
+        }
+        philox_store(out + i, c0);
+        philox_store(out + n + i, c1);
+        philox_store(out + 2 * n + i, c2);
+        philox_store(out + 3 * n + i, c3);
+    }
+    philox4x32_tail(i, n, ctr, out, k0, k1);
+}
+#else
+static void philox4x32(
+    size_t n,
+    const uint32_t *KERNEL_RESTRICT ctr,
+    uint32_t *KERNEL_RESTRICT out,
+    uint32_t k0,
+    uint32_t k1
+) {
+    philox4x32_tail(0, n, ctr, out, k0, k1);
+}
+#endif
+
+static const SimdKernels *make_kernels(SimdIsa isa, const char *name) {
+    static const SimdKernels k{
+        isa, name, gravity_j2, axpy, rk4_combine, ep_to_dcm, ep_kde, philox4x32
+    };
+    return &k;
+}
+
+#undef KERNEL_RESTRICT
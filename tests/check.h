@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+
+// -----------------------------------------------------------------------------
+// Test Checks
+// -----------------------------------------------------------------------------
+// Each test is a small executable registered with ctest. Checks report every
+// failure and keep going; main returns check_result() so the run fails if
+// any check did.
+
+inline int check_failures = 0;
+
+inline void check(bool ok, const char *what, const char *file, int line) {
+    if (!ok) {
+        std::printf("%s:%d: check failed: %s\n", file, line, what);
+        check_failures++;
+    }
+}
+
+// |a - b| <= tol
+inline void check_close(
+    double a,
+    double b,
+    double tol,
+    const char *what,
+    const char *file,
+    int line
+) {
+    if (!(std::abs(a - b) <= tol)) {
+        std::printf(
+            "%s:%d: check failed: %s (%.17g vs %.17g, |diff| %.3g > %.3g)\n",
+            file,
+            line,
+            what,
+            a,
+            b,
+            std::abs(a - b),
+            tol
+        );
+        check_failures++;
+    }
+}
+
+inline int check_result() {
+    if (check_failures > 0) {
+        std::printf("%d check(s) failed\n", check_failures);
+        return 1;
+    }
+    return 0;
+}
+
+#define CHECK(cond) check((cond), #cond, __FILE__, __LINE__)
+#define CHECK_CLOSE(a, b, tol)                                                 \
+    check_close((a), (b), (tol), #a " == " #b, __FILE__, __LINE__)
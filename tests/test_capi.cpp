@@ -0,0 +1,135 @@
+// C ABI: strided and stride 0 rows give the same results as the C++ calls,
+// the J2 batch agrees with the gravity model propagator, and bad arguments
+// come back as OADCS_EINVAL with a message instead of hanging or throwing.
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "attitude.h"
+#include "check.h"
+#include "egm_embedded.h"
+#include "oadcs.h"
+#include "typedefs.h"
+
+int main() {
+    CHECK(oadcs_abi_version() == OADCS_ABI_VERSION);
+
+    // Quaternions in the first 4 columns of rows of 6, DCMs into rows of 12
+    const size_t n = 5;
+    std::vector<f64> q(6 * n, -1.), R(12 * n, -7.);
+    for (size_t i = 0; i < n; i++) {
+        vec4 ep(std::sin(i + 1.), std::cos(2. * i), 0.3, 1.);
+        ep.normalize();
+        for (int c = 0; c < 4; c++) {
+            q[6 * i + c] = ep(c);
+        }
+    }
+    CHECK(oadcs_ep_to_dcm(n, q.data(), 48, R.data(), 96) == OADCS_OK);
+    for (size_t i = 0; i < n; i++) {
+        mat3 M = ep_to_dcm<f64>(vec4(eig::Map<const vec4>(&q[6 * i])));
+        eig::Map<const eig::Matrix<f64, 3, 3, eig::RowMajor>> Ri(&R[12 * i]);
+        CHECK(Ri == M);
+        CHECK((Ri * Ri.transpose() - mat3::Identity()).norm() < 1e-15);
+        CHECK(R[12 * i + 9] == -7. && R[12 * i + 11] == -7.);
+    }
+
+    // The DCMs back to quaternions: the conjugates, up to sign
+    std::vector<f64> qb(4 * n);
+    CHECK(oadcs_dcm_to_ep(n, R.data(), 96, qb.data(), 32) == OADCS_OK);
+    for (size_t i = 0; i < n; i++) {
+        vec4 conj(-q[6 * i], -q[6 * i + 1], -q[6 * i + 2], q[6 * i + 3]);
+        vec4 back = eig::Map<const vec4>(&qb[4 * i]);
+        CHECK(std::min((back - conj).norm(), (back + conj).norm()) < 1e-14);
+    }
+
+    // Stride 0 repeats one body rate for every quaternion
+    const f64 w[3] = {0.01, -0.02, 0.03};
+    std::vector<f64> dq(4 * n);
+    CHECK(oadcs_ep_kde(n, q.data(), 48, w, 0, dq.data(), 32) == OADCS_OK);
+    for (size_t i = 0; i < n; i++) {
+        vec4 ref = ep_kde<f64>(
+            vec4(eig::Map<const vec4>(&q[6 * i])), vec3(w[0], w[1], w[2])
+        );
+        CHECK(vec4(eig::Map<const vec4>(&dq[4 * i])) == ref);
+    }
+
+    // Argument errors
+    const int bad_seq[3] = {3, 1, 4};
+    CHECK(oadcs_ea_to_dcm(1, w, 24, bad_seq, R.data(), 72) == OADCS_EINVAL);
+    CHECK(std::strlen(oadcs_last_error()) > 0);
+    CHECK(oadcs_ep_to_dcm(1, nullptr, 32, R.data(), 72) == OADCS_EINVAL);
+    CHECK(oadcs_ep_to_dcm(2, q.data(), 44, R.data(), 72) == OADCS_EINVAL);
+
+    // Degree 2, order 0 field against the point mass + J2 batch
+    const f64 mu = 398600.4418, Re = 6378.137;
+    const f64 J2 = -std::sqrt(5.) * embedded_egm(1984, 2, 0).getC(2, 0);
+    oadcs_gravity *g = oadcs_gravity_create(mu, Re, 1984, 2, 0, 0.);
+    CHECK(g != nullptr);
+    if (!g) {
+        return check_result();
+    }
+    std::vector<f64> x0(8 * n), xf(6 * n), xj(6 * n);
+    for (size_t i = 0; i < n; i++) {
+        f64 r = 6800. + 100. * i, v = std::sqrt(mu / r), inc = 0.3 * i;
+        f64 x[6] = {r, 0., 0., 0., v * std::cos(inc), v * std::sin(inc)};
+        std::memcpy(&x0[8 * i], x, sizeof(x));
+    }
+    CHECK(
+        oadcs_propagate(g, n, x0.data(), 64, 0., 600., 10., xf.data(), 48, 2)
+        == OADCS_OK
+    );
+    CHECK(
+        oadcs_propagate_j2(n, mu, J2, Re, x0.data(), 64, 10., 60, xj.data(), 48)
+        == OADCS_OK
+    );
+    for (size_t i = 0; i < n; i++) {
+        vec6 a = eig::Map<const vec6>(&xf[6 * i]);
+        vec6 b = eig::Map<const vec6>(&xj[6 * i]);
+        CHECK((a - b).head<3>().norm() < 1e-9);
+    }
+
+    // The propagator lands on the trajectory's samples
+    std::vector<f64> traj(7 * 61);
+    CHECK(
+        oadcs_propagate_trajectory(g, x0.data(), 0., 10., 60, traj.data(), 56)
+        == OADCS_OK
+    );
+    vec6 last = eig::Map<const vec6>(&traj[7 * 60]);
+    CHECK(last == vec6(eig::Map<const vec6>(xf.data())));
+
+    // Time steps that cannot advance the clock are refused, not looped on
+    const f64 nan = std::numeric_limits<f64>::quiet_NaN();
+    const f64 big = 1e17;
+    f64 *x = x0.data();
+    CHECK(
+        oadcs_propagate(g, 1, x, 64, big, 2. * big, 1., xf.data(), 48, 1)
+        == OADCS_EINVAL
+    );
+    CHECK(
+        oadcs_propagate(g, 1, x0.data(), 64, 0., 1., nan, xf.data(), 48, 1)
+        == OADCS_EINVAL
+    );
+    CHECK(
+        oadcs_propagate_trajectory(g, x0.data(), 0., 0., 3, traj.data(), 56)
+        == OADCS_EINVAL
+    );
+    CHECK(
+        oadcs_propagate_trajectory(g, x0.data(), big, 1., 3, traj.data(), 56)
+        == OADCS_EINVAL
+    );
+    CHECK(
+        oadcs_propagate_trajectory(g, x0.data(), 0., -1., 3, traj.data(), 56)
+        == OADCS_EINVAL
+    );
+
+    // A short last step lands exactly on tf
+    CHECK(
+        oadcs_propagate(g, 1, x0.data(), 64, 0., 1., 0.3, xf.data(), 48, 1)
+        == OADCS_OK
+    );
+
+    oadcs_gravity_destroy(g);
+    return check_result();
+}
@@ -0,0 +1,73 @@
+// Checkpoint store: stable model keys, thinned history and recovery from
+// truncated files.
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "check.h"
+#include "checkpoint.h"
+
+int main() {
+    // Keys depend on the values only
+    std::vector<f64> J{0., 1.08262668e-3};
+    u64 k1 = model_key(398600.4418, 8, true, J, std::string("EGM84"));
+    u64 k2 = model_key(398600.4418, 8, true, J, std::string("EGM84"));
+    u64 k3 = model_key(398600.4418, 9, true, J, std::string("EGM84"));
+    CHECK(k1 == k2);
+    CHECK(k1 != k3);
+
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path()
+                   / ("oadcs_test_checkpoint_" + std::to_string(getpid()));
+    fs::remove_all(dir);
+    {
+        // Unbounded by default
+        CheckpointStore<vec6> store(dir);
+        for (int i = 0; i < 100; i++) {
+            store.append(k1, {10. * i, 1., vec6::Constant(i)});
+        }
+        CHECK(store.load(k1).size() == 100);
+        store.remove(k1);
+    }
+    {
+        CheckpointStore<vec6> store(dir, 8);
+        for (int i = 0; i < 1000; i++) {
+            vec6 x = vec6::Constant(i);
+            store.append(k1, {10. * i, 1., x});
+        }
+        std::vector<Checkpoint<vec6>> records = store.load(k1);
+        CHECK(records.size() <= 8);
+        CHECK(records.front().t == 0. && records.back().t == 9990.);
+        for (size_t i = 0; i < records.size(); i++) {
+            CHECK(records[i].x == vec6::Constant(records[i].t / 10.));
+            if (i > 0) {
+                CHECK(records[i].t > records[i - 1].t);
+            }
+        }
+        CHECK(!fs::exists(fs::path(store.path(k1)) += ".tmp"));
+
+        // The newest records stay dense, the oldest survive thinned
+        CHECK(records[records.size() - 2].t == 9980.);
+        auto resume = store.resume_point(k1, 55.);
+        CHECK(resume && resume->t <= 55.);
+        resume = store.resume_point(k1, 9985.);
+        CHECK(resume && resume->t == 9980.);
+    }
+    {
+        // A file cut short inside its header gets a new one
+        CheckpointStore<vec6> store(dir);
+        store.remove(k3);
+        std::ofstream(store.path(k3), std::ios::binary) << "OADC";
+        store.append(k3, {1., 1., vec6::Ones()});
+        store.append(k3, {2., 1., vec6::Ones()});
+        std::vector<Checkpoint<vec6>> records = store.load(k3);
+        CHECK(records.size() == 2 && records[1].t == 2.);
+    }
+    fs::remove_all(dir);
+
+    return check_result();
+}
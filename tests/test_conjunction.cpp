@@ -0,0 +1,98 @@
+// Orbit path filter: no false negatives for nearly coplanar eccentric
+// orbits, still rejects clearly separated paths.
+
+#include <cmath>
+
+#include "check.h"
+#include "conjunction.h"
+
+// Elliptic orbit state at periapsis, periapsis direction at angle w in the
+// plane inclined by i about x
+vec6 periapsis_state(f64 a, f64 e, f64 i, f64 w) {
+    f64 rp = a * (1. - e);
+    f64 vp = std::sqrt(mu_earth * (1. + e) / rp);
+    vec3 n = vec3(0., -std::sin(i), std::cos(i)); // orbit normal
+    vec3 x = vec3::UnitX();
+    vec3 y = n.cross(x);
+    vec3 p = std::cos(w) * x + std::sin(w) * y;
+    vec6 s;
+    s << rp * p, vp * n.cross(p);
+    return s;
+}
+
+vec3 path_point(const OrbitShell &s, f64 nu) {
+    f64 e = s.e_vec.norm();
+    vec3 e_hat = e > 0. ? vec3(s.e_vec / e) : vec3(vec3::UnitX());
+    vec3 q = s.h_hat.cross(e_hat);
+    return s.p / (1. + e * std::cos(nu))
+           * (std::cos(nu) * e_hat + std::sin(nu) * q);
+}
+
+// Minimum of f over [0, 2 pi): coarse samples, then a ternary search
+// around the best one
+template <typename Fn> f64 minimize_angle(Fn &&f) {
+    const int n = 360;
+    const f64 h = twopi / n;
+    int best = 0;
+    f64 f_best = f(0.);
+    for (int i = 1; i < n; i++) {
+        f64 fi = f(i * h);
+        if (fi < f_best) {
+            best = i;
+            f_best = fi;
+        }
+    }
+    f64 lo = (best - 1) * h, hi = (best + 1) * h;
+    for (int it = 0; it < 60; it++) {
+        f64 m1 = lo + (hi - lo) / 3.;
+        f64 m2 = hi - (hi - lo) / 3.;
+        if (f(m1) < f(m2)) {
+            hi = m2;
+        } else {
+            lo = m1;
+        }
+    }
+    return std::min(f_best, f(0.5 * (lo + hi)));
+}
+
+// Closest distance between the two orbit paths
+f64 path_distance(const OrbitShell &a, const OrbitShell &b) {
+    return minimize_angle([&](f64 nu_a) {
+        vec3 pa = path_point(a, nu_a);
+        return minimize_angle([&](f64 nu_b) {
+            return (pa - path_point(b, nu_b)).norm();
+        });
+    });
+}
+
+int main() {
+    const f64 D = 15.;
+
+    // Relative inclination 2e-3 rad, apses 90 deg apart: the radii differ
+    // by ~600 km at the nodes, but the paths cross within D away from them
+    OrbitShell a = orbit_shell(periapsis_state(7500., 0.05, 0., 0.), mu_earth);
+    OrbitShell b
+        = orbit_shell(periapsis_state(7500., 0.05, 2e-3, pi / 2.), mu_earth);
+    CHECK(path_distance(a, b) <= D);
+    CHECK(paths_overlap(a, b, D));
+    CHECK(paths_overlap(b, a, D));
+
+    // Same shapes at 0.5 rad relative inclination: far apart at both nodes
+    OrbitShell c
+        = orbit_shell(periapsis_state(7500., 0.05, 0.5, pi / 2.), mu_earth);
+    CHECK(path_distance(a, c) > D);
+    CHECK(!paths_overlap(a, c, D));
+
+    // Whatever the filter rejects really is farther than D
+    for (f64 i : {1e-3, 3e-3, 1e-2, 0.1, 1.}) {
+        for (f64 w : {0., 0.7, 2., 3.5}) {
+            OrbitShell s
+                = orbit_shell(periapsis_state(7400., 0.03, i, w), mu_earth);
+            if (!paths_overlap(a, s, D)) {
+                CHECK(path_distance(a, s) > D);
+            }
+        }
+    }
+
+    return check_result();
+}
@@ -0,0 +1,89 @@
+// Batch least squares recovers a perturbed epoch state from synthetic
+// tracking, and the state it returns is the one its rms belongs to.
+
+#include <cmath>
+#include <vector>
+
+#include "FixedIntegrators.h"
+#include "check.h"
+#include "constants.h"
+#include "gravity.h"
+#include "integrator.h"
+#include "orbit_determination.h"
+#include "random.h"
+
+using Forces = ForcePolicy3D<vec6, ZonalGravityPolicy<vec6>>;
+using Integ = FixedStepIntegrator<STMEOM<Forces>, vec42, RK4Policy>;
+
+int main() {
+    Forces forces(
+        ZonalGravityPolicy<vec6>(mu_earth, {0., 1.08262668e-3}, r_earth, 2)
+    );
+    Integ integ(STMEOM<Forces>(forces), 20.);
+
+    vec6 truth;
+    truth << 6800., 300., 900., -0.4, 6.9, 3.2;
+    std::vector<GroundStation> stations = {
+        {vec3(6378.137, 0., 0.)},
+        {vec3(0., 6378.137, 0.)},
+        {vec3(-4500., 0., 4500.)},
+    };
+
+    // Truth at the observation times, through the same integrator
+    const f64 sigma[4] = {1e-3, 1e-6, 5e-6, 5e-6};
+    std::vector<f64> times;
+    std::vector<vec42> states;
+    Integ truth_integ = integ;
+    std::vector<Observation> obs;
+    RandomStream rs(2024, 0, 0, 0);
+    vec42 y = stm_initial(truth);
+    f64 t = 0.;
+    for (f64 te = 60.; te <= 6. * 3600.; te += 60.) {
+        truth_integ.integrate(t, te, y, times, states);
+        y = states.back();
+        t = te;
+        for (int k = 0; k < 3; k++) {
+            vec6 xs = station_state(stations[k], te, 0.);
+            vec3 rho = y.head<3>() - xs.head<3>();
+            if (rho.dot(xs.head<3>()) <= 0.) {
+                continue; // below the horizon
+            }
+            for (int m = 0; m < 4; m++) {
+                auto type = static_cast<MeasurementType>(m);
+                vec6 x = y.head<6>();
+                f64 z = predict_measurement<f64>(type, x, xs);
+                obs.push_back(
+                    {te, type, k, z + sigma[m] * rs.normal(), sigma[m]}
+                );
+            }
+        }
+    }
+    CHECK(obs.size() > 200);
+
+    vec6 guess = truth;
+    guess.head<3>() += vec3(4., -3., 2.);
+    guess.tail<3>() += vec3(-2e-3, 1e-3, 2e-3);
+
+    BatchConfig cfg;
+    cfg.block_size = 64;
+    BatchResult res = batch_least_squares(integ, 0., guess, obs, stations, cfg);
+    CHECK(res.iterations < cfg.max_iter);
+    CHECK(std::abs(res.rms - 1.) < 0.2);
+    for (int i = 0; i < 6; i++) {
+        CHECK(std::abs(res.x0(i) - truth(i)) < 5. * std::sqrt(res.P(i, i)));
+    }
+
+    // Running out of iterations returns the state the rms was computed at:
+    // one more single-iteration run from it reports the same rms
+    cfg.max_iter = 2;
+    BatchResult cut = batch_least_squares(integ, 0., guess, obs, stations, cfg);
+    CHECK(cut.iterations == 2);
+    cfg.max_iter = 1;
+    BatchResult again
+        = batch_least_squares(integ, 0., cut.x0, obs, stations, cfg);
+    CHECK(again.x0 == cut.x0);
+    CHECK(again.rms == cut.rms);
+    CHECK(again.residuals == cut.residuals);
+
+    return check_result();
+}
@@ -0,0 +1,116 @@
+// Registry systems share one force model across entities and threads: with
+// SRP in the model, every entity still gets its own shadow value, and a
+// threaded step matches each entity stepped alone with a fresh model.
+
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "FixedIntegrators.h"
+#include "check.h"
+#include "constants.h"
+#include "ephemeris.h"
+#include "gravity.h"
+#include "registry.h"
+#include "scheduler.h"
+#include "srp.h"
+
+using Forces = ForcePolicy3D<
+    vec6,
+    NewtonianGravityPolicy<vec6>,
+    ZonalGravityPolicy<vec6>,
+    SRPPolicy<vec6>>;
+using Eom = EOM<vec6, Forces>;
+
+int main() {
+    auto eph = std::make_shared<const SunMoonEphemeris>(jd_j2000, 0., 86400.);
+    auto make_forces = [&] {
+        return Forces(
+            NewtonianGravityPolicy<vec6>(mu_earth),
+            ZonalGravityPolicy<vec6>(
+                mu_earth, {0., 1.08262668e-3}, r_earth, 2, false
+            ),
+            SRPPolicy<vec6>(eph, 1.3, 10., 500., ShadowModel::CONICAL)
+        );
+    };
+    const Forces forces = make_forces();
+
+    // A ring of satellites around the terminator: sunlit, penumbra, umbra
+    const f64 t = 0.;
+    const f64 dt = 30.;
+    vec3 s = eph->sun_position(t).normalized();
+    vec3 p = s.cross(vec3(0., 0., 1.)).normalized();
+    vec3 h = s.cross(p);
+    std::vector<vec6> x0;
+    for (int i = 0; i < 64; i++) {
+        f64 th = 2. * pi * i / 64.;
+        vec3 r = 7000. * (std::cos(th) * s + std::sin(th) * p);
+        vec6 x;
+        x << r, std::sqrt(mu_earth / 7000.) * h.cross(r.normalized());
+        x0.push_back(x);
+    }
+    Registry reg;
+    for (const vec6 &x : x0) {
+        reg.set_state(reg.create("sat"), x);
+    }
+
+    // Acceleration system
+    std::vector<vec3> acc;
+    gravity_system(reg, forces, t, acc);
+    for (size_t i = 0; i < x0.size(); i++) {
+        CHECK(acc[i] == make_forces().acceleration(t, x0[i]));
+    }
+
+    // Threaded step
+    translation_step(reg, forces, t, dt, 4);
+    for (size_t i = 0; i < x0.size(); i++) {
+        Eom eom(make_forces());
+        vec6 x = RK4Policy<Eom, vec6>::step(eom, t, x0[i], dt).second;
+        CHECK(reg.state(reg.translating[i]) == x);
+    }
+
+    // Same step from a scheduler task
+    Registry reg_task;
+    for (const vec6 &x : x0) {
+        reg_task.set_state(reg_task.create("sat"), x);
+    }
+    Scheduler sched(t, 1e-6, 2);
+    add_translation_task(sched, reg_task, forces, dt, {}, 4);
+    sched.run_until(t + dt);
+    for (size_t i = 0; i < x0.size(); i++) {
+        CHECK(reg_task.state(reg_task.translating[i]) == reg.state(i));
+    }
+
+    // Tasks default to every core the scheduler allows when they fire alone
+    // in their level, one worker when they share it, and all cores when the
+    // scheduler runs levels serially
+    CHECK(sched.task_threads(3) == 3);
+    for (int n : {0, 2, 1}) {
+        Scheduler s(0., 1., n);
+        std::atomic<int> alone{-2}, shared{-2};
+        TaskId a = s.add("alone", 1., [&](f64) {
+            alone = s.task_threads(-1);
+        });
+        s.add("x", 1., [&](f64) { shared = s.task_threads(-1); }, {a});
+        s.add("y", 1., [](f64) {}, {a});
+        s.run_until(1.);
+        CHECK(alone == (n == 1 ? 0 : n));
+        CHECK(shared == (n == 1 ? 0 : 1));
+        CHECK(s.task_threads(-1) == (n == 1 ? 0 : n));
+    }
+
+    // parallel_for runs on the shared pool, and falls back to its own
+    // threads when nested inside a pool job
+    std::atomic<int> sum{0};
+    parallel_for(
+        8,
+        [&](int i) {
+            parallel_for(8, [&](int j) { sum += i * 8 + j; }, 4);
+        },
+        4
+    );
+    CHECK(sum == 64 * 63 / 2);
+
+    return check_result();
+}
@@ -0,0 +1,127 @@
+// Regularized EOMs: the KS transform round-trips, and KS and Sundman
+// propagations land on the Cartesian orbit at equal physical time while
+// conserving the Kepler energy.
+
+#include <cmath>
+#include <vector>
+
+#include "FixedIntegrators.h"
+#include "check.h"
+#include "constants.h"
+#include "gravity.h"
+#include "integrator.h"
+#include "regularization.h"
+
+using Kepler = ForcePolicy3D<vec6, NewtonianGravityPolicy<vec6>>;
+using J2Forces = ForcePolicy3D<
+    vec6,
+    NewtonianGravityPolicy<vec6>,
+    ZonalGravityPolicy<vec6>>;
+
+f64 energy(const vec6 &x) {
+    return 0.5 * x.tail<3>().squaredNorm() - mu_earth / x.head<3>().norm();
+}
+
+// Cartesian reference at tf, tight adaptive steps
+template <typename Forces>
+vec6 cartesian(const Forces &forces, const vec6 &x0, f64 tf) {
+    using Eom = EOM<vec6, Forces>;
+    AdaptiveStepIntegrator<vec6, Eom, DormandPrince45Policy> integ(
+        Eom(forces), 1., 1e-13
+    );
+    std::vector<f64> times;
+    std::vector<vec6> states;
+    integ.integrate(0., tf, x0, times, states);
+    return states.back();
+}
+
+// KS propagation to physical time tf in n RK4 steps of fictitious time
+template <typename Forces>
+vec10 ks(const Forces &forces, const vec6 &x0, f64 tf, int n) {
+    using Eom = KSEOM<Forces>;
+    Eom f(forces, mu_earth);
+    f64 s_f = sundman_span(mu_earth, x0, tf);
+    FixedStepIntegrator<Eom, vec10, RK4Policy> integ(f, s_f / n);
+    std::vector<f64> times;
+    std::vector<vec10> states;
+    integ.integrate(0., s_f, cart_to_ks(x0, 0., mu_earth), times, states);
+    return land_on_time<RK4Policy>(
+               f, times.back(), states.back(), tf, 9, s_f / n, 1e-10
+    )
+        .second;
+}
+
+int main() {
+    // Round trip on both square-root branches
+    vec6 states[3];
+    states[0] << 7000., -1200., 300., 1.1, 7.2, -0.4;
+    states[1] << -6500., 2100., -900., -2.3, -6.5, 1.9;
+    states[2] << -0.5, 4.2e3, 5.1e3, 7.4, 0.2, -0.3;
+    for (const vec6 &x : states) {
+        vec10 y = cart_to_ks(x, 12., mu_earth);
+        vec6 back = ks_to_cart(y);
+        CHECK((back.head<3>() - x.head<3>()).norm() < 1e-12 * 1e4);
+        CHECK((back.tail<3>() - x.tail<3>()).norm() < 1e-12 * 10.);
+        CHECK(std::abs(ks_bilinear(y)) < 1e-10);
+        CHECK_CLOSE(y(8), -energy(x), 1e-13 * std::abs(energy(x)));
+        CHECK(ks_time(y) == 12.);
+        CHECK(std::abs(y.head<4>().squaredNorm() - x.head<3>().norm()) < 1e-9);
+    }
+
+    // Eccentric orbit (e = 0.3) over one and a half periods
+    const f64 a = 8000., e = 0.3;
+    f64 rp = a * (1. - e);
+    vec6 x0;
+    x0 << rp, 0., 0., 0., std::sqrt(mu_earth * (1. + e) / rp) * 0.8,
+        std::sqrt(mu_earth * (1. + e) / rp) * 0.6;
+    const f64 tf = 1.5 * twopi * std::sqrt(a * a * a / mu_earth);
+
+    Kepler kepler{NewtonianGravityPolicy<vec6>(mu_earth)};
+    vec6 ref = cartesian(kepler, x0, tf);
+
+    vec10 yk = ks(kepler, x0, tf, 600);
+    CHECK(std::abs(ks_time(yk) - tf) < 1e-9);
+    vec6 xk = ks_to_cart(yk);
+    CHECK((xk.head<3>() - ref.head<3>()).norm() < 1e-4);
+    CHECK((xk.tail<3>() - ref.tail<3>()).norm() < 1e-7);
+    // h only moves under perturbations, and the Cartesian energy follows it
+    f64 h0 = cart_to_ks(x0, 0., mu_earth)(8);
+    CHECK(std::abs(yk(8) - h0) <= 1e-14 * h0);
+    CHECK(std::abs(energy(xk) - energy(x0)) < 1e-10 * std::abs(energy(x0)));
+    CHECK(std::abs(ks_bilinear(yk)) < 1e-9);
+
+    // Sundman, s proportional to eccentric anomaly
+    {
+        using Eom = SundmanEOM<Kepler>;
+        Eom f(kepler);
+        f64 s_f = sundman_span(mu_earth, x0, tf);
+        FixedStepIntegrator<Eom, vec7, RK4Policy> integ(f, s_f / 2000);
+        std::vector<f64> times;
+        std::vector<vec7> ys;
+        integ.integrate(0., s_f, to_sundman(x0, 0.), times, ys);
+        vec7 y = land_on_time<RK4Policy>(
+                     f, times.back(), ys.back(), tf, 6, s_f / 2000, 1e-10
+        )
+                     .second;
+        CHECK(std::abs(y(6) - tf) < 1e-9);
+        vec6 xs = from_sundman(y);
+        CHECK((xs.head<3>() - ref.head<3>()).norm() < 1e-4);
+        CHECK(std::abs(energy(xs) - energy(x0)) < 1e-8 * std::abs(energy(x0)));
+    }
+
+    // J2: KS carries the perturbation through h and still meets the
+    // Cartesian orbit
+    J2Forces j2(
+        NewtonianGravityPolicy<vec6>(mu_earth),
+        ZonalGravityPolicy<vec6>(
+            mu_earth, {0., 1.08262668e-3}, r_earth, 2, false
+        )
+    );
+    vec6 ref_j2 = cartesian(j2, x0, tf);
+    vec10 yj = ks(j2, x0, tf, 600);
+    CHECK(std::abs(yj(8) - h0) > 1e-6 * h0);
+    CHECK((ks_to_cart(yj).head<3>() - ref_j2.head<3>()).norm() < 1e-4);
+    CHECK((ref_j2.head<3>() - ref.head<3>()).norm() > 1.);
+
+    return check_result();
+}
@@ -0,0 +1,54 @@
+// Scenario runner: a scenario gives the same result alone and in a batch,
+// and a batch refuses two scenarios writing the same output.
+
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "check.h"
+#include "scenario.h"
+
+int main() {
+    std::istringstream in(
+        "r0 = 7000 0 0\n"
+        "v0 = 0 7.546 0\n"
+        "tf = 5400\n"
+        "dt = 60\n"
+        "third_body = sun moon\n"
+    );
+    Scenario s = parse_scenario(in, "leo.scn");
+
+    // Alone and in a batch the scenario gets the same padded ephemeris, so
+    // the same result
+    ModelCache cache;
+    ScenarioResult alone = run_scenario(s, cache);
+    CHECK(alone.ok);
+
+    ModelCache batch_cache;
+    std::vector<ScenarioResult> batch = run_scenarios({s}, batch_cache);
+    CHECK(batch.size() == 1 && batch[0].ok);
+    CHECK(batch[0].xf == alone.xf);
+
+    // Two scenarios with one output
+    Scenario t = s;
+    t.name = "other";
+    t.source = "other.scn";
+    t.output = "./" + s.output;
+    ScenarioSink sink = [](const Scenario &) {
+        return std::unique_ptr<std::ostream>(new std::ostringstream);
+    };
+    bool refused = false;
+    try {
+        run_scenarios({s, t}, cache, sink);
+    } catch (const std::runtime_error &) {
+        refused = true;
+    }
+    CHECK(refused);
+
+    t.output = "other.csv";
+    std::vector<ScenarioResult> both = run_scenarios({s, t}, cache, sink);
+    CHECK(both[0].ok && both[1].ok);
+
+    return check_result();
+}
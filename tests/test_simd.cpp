@@ -0,0 +1,143 @@
+// Every SIMD kernel variant this CPU can run returns the same bits as the
+// baseline variant, and the baseline agrees with the scalar gravity policy
+// and attitude functions.
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "attitude.h"
+#include "check.h"
+#include "gravity.h"
+#include "simd.h"
+
+using Buffer = std::vector<double>;
+
+bool same_bits(const Buffer &a, const Buffer &b) {
+    return a.size() == b.size()
+           && std::memcmp(a.data(), b.data(), a.size() * sizeof(double)) == 0;
+}
+
+constexpr double mu = 398600.4418;
+constexpr double J2 = 1.08262668e-3;
+constexpr double R_earth = 6378.137;
+
+struct Inputs {
+    Buffer r, q, w, k1, k2, k3;
+};
+
+struct Outputs {
+    Buffer a, y, x4, R, dq;
+};
+
+Inputs make_inputs(size_t n) {
+    Buffer r(3 * n), q(4 * n), w(3 * n), k1(3 * n), k2(3 * n), k3(3 * n);
+    for (size_t i = 0; i < n; i++) {
+        double s = 6700. + 37. * i;
+        r[i] = s * std::cos(0.1 * i);
+        r[n + i] = s * std::sin(0.1 * i);
+        r[2 * n + i] = 0.4 * s * std::sin(0.07 * i);
+        double qn = 0.;
+        for (int c = 0; c < 4; c++) {
+            q[c * n + i] = std::sin(1.3 * i + c);
+            qn += q[c * n + i] * q[c * n + i];
+        }
+        for (int c = 0; c < 4; c++) {
+            q[c * n + i] /= std::sqrt(qn);
+        }
+        for (int c = 0; c < 3; c++) {
+            w[c * n + i] = 0.01 * (c + 1) * std::cos(0.3 * i);
+            k1[c * n + i] = std::cos(0.2 * i + c);
+            k2[c * n + i] = std::sin(0.5 * i - c);
+            k3[c * n + i] = std::cos(0.9 * i * c);
+        }
+    }
+    return {r, q, w, k1, k2, k3};
+}
+
+Outputs run(const SimdKernels &K, const Inputs &in, size_t n) {
+    Outputs o{Buffer(3 * n), Buffer(3 * n), Buffer(3 * n), Buffer(9 * n),
+              Buffer(4 * n)};
+    K.gravity_j2(n, in.r.data(), o.a.data(), mu, J2, R_earth);
+    K.axpy(3 * n, 0.37, o.a.data(), in.r.data(), o.y.data());
+    K.rk4_combine(
+        3 * n,
+        10.,
+        in.r.data(),
+        in.k1.data(),
+        in.k2.data(),
+        in.k3.data(),
+        o.a.data(),
+        o.x4.data()
+    );
+    K.ep_to_dcm(n, in.q.data(), o.R.data());
+    K.ep_kde(n, in.q.data(), in.w.data(), o.dq.data());
+    return o;
+}
+
+// Largest difference of the baseline outputs from the scalar reference
+// implementations, relative to each element's magnitude
+struct Errors {
+    double a = 0., R = 0., dq = 0.;
+};
+
+Errors reference_errors(const Inputs &in, const Outputs &o, size_t n) {
+    const ZonalGravityPolicy<vec6> zonal(mu, {0., J2}, R_earth, 2);
+    Errors e;
+    for (size_t i = 0; i < n; i++) {
+        vec6 x;
+        x << in.r[i], in.r[n + i], in.r[2 * n + i], 0., 0., 0.;
+        vec3 a_ref = policy_acceleration(zonal, 0., x);
+        vec3 a(o.a[i], o.a[n + i], o.a[2 * n + i]);
+        e.a = std::max(e.a, (a - a_ref).norm() / a_ref.norm());
+
+        vec4 q(in.q[i], in.q[n + i], in.q[2 * n + i], in.q[3 * n + i]);
+        mat3 R_ref = ep_to_dcm<f64>(q);
+        for (int j = 0; j < 9; j++) {
+            e.R = std::max(e.R, std::abs(o.R[j * n + i] - R_ref(j / 3, j % 3)));
+        }
+
+        vec3 w(in.w[i], in.w[n + i], in.w[2 * n + i]);
+        vec4 dq_ref = ep_kde<f64>(q, w);
+        vec4 dq(o.dq[i], o.dq[n + i], o.dq[2 * n + i], o.dq[3 * n + i]);
+        e.dq = std::max(e.dq, (dq - dq_ref).norm() / w.norm());
+    }
+    return e;
+}
+
+int main() {
+    // Odd size, so the vector loops also run their scalar tails
+    const size_t n = 1029;
+    const SimdKernels *baseline = simd_kernels_baseline();
+    CHECK(baseline != nullptr);
+    if (!baseline) {
+        return check_result();
+    }
+    Inputs in = make_inputs(n);
+    Outputs ref = run(*baseline, in, n);
+
+    // Bit agreement below only carries over to the formulas through this
+    Errors e = reference_errors(in, ref, n);
+    CHECK(e.a < 1e-14);
+    CHECK(e.R < 1e-15);
+    CHECK(e.dq < 1e-15);
+
+    for (const SimdKernels *K : {simd_kernels_avx2(), simd_kernels_avx512()}) {
+        if (!K || static_cast<int>(K->isa) > static_cast<int>(simd_detect())) {
+            continue;
+        }
+        Outputs o = run(*K, in, n);
+        CHECK(same_bits(o.a, ref.a));
+        CHECK(same_bits(o.y, ref.y));
+        CHECK(same_bits(o.x4, ref.x4));
+        CHECK(same_bits(o.R, ref.R));
+        CHECK(same_bits(o.dq, ref.dq));
+    }
+    CHECK(
+        static_cast<int>(simd_kernels().isa)
+        <= static_cast<int>(simd_detect())
+    );
+
+    return check_result();
+}
@@ -0,0 +1,76 @@
+// SRP through one shared force model gives every state its own shadow value:
+// several states evaluated at the same t, in any order, match a fresh model
+// per state bit for bit. The default smooth shadow stays inside the
+// geometric penumbra.
+
+#include <memory>
+#include <vector>
+
+#include "check.h"
+#include "constants.h"
+#include "ephemeris.h"
+#include "gravity.h"
+#include "srp.h"
+
+using Forces = ForcePolicy3D<vec6, SRPPolicy<vec6>>;
+
+int main() {
+    auto eph = std::make_shared<const SunMoonEphemeris>(jd_j2000, 0., 86400.);
+
+    for (ShadowModel model : {ShadowModel::CONICAL, ShadowModel::SMOOTH}) {
+        const SRPPolicy<vec6> srp(eph, 1.3, 10., 500., model, 2.5);
+        const Forces shared(srp);
+
+        for (f64 t : {0., 1., 2., 600., 43200.}) {
+            vec3 s = eph->sun_position(t).normalized();
+            vec3 p = s.cross(vec3(0., 0., 1.)).normalized();
+            f64 rm = 7000.;
+            // Sunlit, umbra, near the shadow edge on both sides, sunlit
+            std::vector<vec3> positions{
+                rm * s,
+                -rm * s,
+                -std::sqrt(rm * rm - 6378. * 6378.) * s + 6378. * p,
+                -std::sqrt(rm * rm - 6420. * 6420.) * s - 6420. * p,
+                rm * p,
+            };
+            std::vector<vec6> states;
+            for (const vec3 &r : positions) {
+                vec6 x;
+                x << r, 7.5 * p.cross(r.normalized());
+                states.push_back(x);
+            }
+
+            std::vector<vec3> fresh;
+            for (const vec6 &x : states) {
+                fresh.push_back(Forces(srp).acceleration(t, x));
+            }
+            CHECK(fresh[0].norm() > 0.);
+            CHECK(fresh[1].norm() == 0.);
+
+            // Forward, backward and interleaved through the shared model
+            for (int pass = 0; pass < 3; pass++) {
+                for (size_t j = 0; j < states.size(); j++) {
+                    size_t i = pass == 0   ? j
+                               : pass == 1 ? states.size() - 1 - j
+                                           : (2 * j) % states.size();
+                    vec3 a = shared.acceleration(t, states[i]);
+                    CHECK(a == fresh[i]);
+                }
+            }
+        }
+    }
+
+    // Smooth shadow at the umbra and sunlight edges of the conical penumbra
+    const f64 a = 0.0047;
+    const f64 b = 1.1;
+    ShadowGeometry umbra_edge{a, b, b - a};
+    ShadowGeometry sunlit_edge{a, b, b + a};
+    CHECK(shadow_conical(umbra_edge) == 0.);
+    CHECK(shadow_smooth(umbra_edge) < 0.01);
+    CHECK(shadow_smooth(sunlit_edge) > 0.99);
+    CHECK(shadow_smooth(umbra_edge, 0.5) > 0.1);
+    const SRPPolicy<vec6> srp(eph, 1.3, 10., 500.);
+    CHECK(srp.sharpness == 2.5);
+
+    return check_result();
+}
@@ -0,0 +1,67 @@
+// Telemetry ring: records round trip, and shared segments are never taken
+// from another live producer.
+
+#include <stdexcept>
+#include <string>
+
+#include <unistd.h>
+
+#include "check.h"
+#include "telemetry.h"
+
+int main() {
+    TelemetryRing ring(8, 3);
+    TelemetryReader reader(ring);
+    for (int k = 0; k < 5; k++) {
+        ring.publish(7, 10. * k, vec3(k, k + 1., k + 2.));
+    }
+    TelemetryRecord r;
+    for (int k = 0; k < 5; k++) {
+        CHECK(reader.next(r));
+        CHECK(r.id == 7 && r.t == 10. * k && r.x.size() == 3);
+        CHECK(r.x[0] == k && r.x[2] == k + 2.);
+    }
+    CHECK(!reader.next(r));
+    CHECK(!reader.finished());
+    ring.close();
+    CHECK(reader.finished());
+
+#ifdef OADCS_TELEMETRY_SHM
+    const std::string name = "/oadcs_test_" + std::to_string(getpid());
+    {
+        TelemetryRing a = TelemetryRing::shared(name, 16, 6);
+        a.publish(1, 1., vec3(1., 2., 3.));
+
+        // The name is taken while a runs
+        bool refused = false;
+        try {
+            TelemetryRing::shared(name, 16, 6);
+        } catch (const std::runtime_error &) {
+            refused = true;
+        }
+        CHECK(refused);
+        TelemetryReader ra = TelemetryReader::attach(name);
+        CHECK(ra.next(r) && r.id == 1);
+
+        // Taking it over explicitly leaves the new segment in place when
+        // the old producer goes away
+        TelemetryRing b = TelemetryRing::shared(name, 16, 6, true);
+        b.publish(2, 2., vec3(4., 5., 6.));
+        {
+            TelemetryRing gone = std::move(a);
+        }
+        TelemetryReader rb = TelemetryReader::attach(name);
+        CHECK(rb.next(r) && r.id == 2);
+    }
+    // The last owner removed it
+    bool removed = false;
+    try {
+        TelemetryReader::attach(name);
+    } catch (const std::runtime_error &) {
+        removed = true;
+    }
+    CHECK(removed);
+#endif
+
+    return check_result();
+}
@@ -0,0 +1,58 @@
+// Sigma points straddling the shadow boundary: the batched sigma point EOM
+// matches a fresh single state EOM per column.
+
+#include <algorithm>
+#include <memory>
+
+#include "check.h"
+#include "constants.h"
+#include "ephemeris.h"
+#include "gravity.h"
+#include "srp.h"
+#include "unscented.h"
+
+using Forces = ForcePolicy3D<
+    vec6,
+    NewtonianGravityPolicy<vec6>,
+    ThirdBodyGravityPolicy<vec6>,
+    SRPPolicy<vec6>>;
+
+int main() {
+    auto eph = std::make_shared<const SunMoonEphemeris>(jd_j2000, 0., 86400.);
+    const Forces forces(
+        NewtonianGravityPolicy<vec6>(mu_earth),
+        ThirdBodyGravityPolicy<vec6>(ThirdBody::SUN, eph),
+        SRPPolicy<vec6>(eph, 1.3, 10., 500., ShadowModel::CONICAL)
+    );
+    const SigmaPointEOM<Forces> sigma_eom(forces);
+
+    const f64 t = 1800.;
+    vec3 s = eph->sun_position(t).normalized();
+    vec3 p = s.cross(vec3(0., 0., 1.)).normalized();
+    const f64 rm = 7000.;
+    vec6 m;
+    m << -std::sqrt(rm * rm - r_earth * r_earth) * s + r_earth * p,
+        7.5 * p.cross(s);
+    mat6 P = mat6::Identity();
+    P.topLeftCorner<3, 3>() *= 4e4; // 200 km, wider than the penumbra
+    P.bottomRightCorner<3, 3>() *= 1e-4;
+
+    SigmaPoints6 X = sigma_points(m, P);
+    SigmaPoints6 dX = sigma_eom(t, X);
+
+    f64 nu_min = 1., nu_max = 0.;
+    for (int j = 0; j < 13; j++) {
+        vec6 x = X.col(j);
+        vec6 dx = EOM<vec6, Forces>(forces)(t, x);
+        CHECK(dX.col(j) == dx);
+        f64 nu = shadow_conical(
+            shadow_geometry(x.head<3>(), eph->sun_position(t))
+        );
+        nu_min = std::min(nu_min, nu);
+        nu_max = std::max(nu_max, nu);
+    }
+    // The points do straddle the boundary
+    CHECK(nu_min < nu_max);
+
+    return check_result();
+}